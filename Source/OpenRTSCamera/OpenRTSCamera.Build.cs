@@ -33,12 +33,19 @@ public class OpenRTSCamera : ModuleRules
 				"CoreUObject",
 				"Engine",
 				"EnhancedInput",
+				"RenderCore",
 				"Slate",
 				"SlateCore",
 				"UMG"
 			}
 		);
 
+		// The networked automation tests run as a listen server and a client in PIE
+		if (Target.bBuildEditor)
+		{
+			PrivateDependencyModuleNames.Add("UnrealEd");
+		}
+
 		DynamicallyLoadedModuleNames.AddRange(
 			new string[]
 			{
@@ -2,19 +2,25 @@
 
 #include "RTSCamera.h"
 
-#include "Blueprint/WidgetLayoutLibrary.h"
+#include "Engine/AssetManager.h"
 #include "Engine/LocalPlayer.h"
 #include "Engine/World.h"
 #include "EnhancedInputComponent.h"
 #include "EnhancedInputSubsystems.h"
+#include "GameFramework/Pawn.h"
 #include "RTSCameraBoundsVolume.h"
+#include "RTSScreenProjector.h"
 #include "Kismet/GameplayStatics.h"
 #include "Kismet/KismetMathLibrary.h"
-#include "Runtime/CoreUObject/Public/UObject/ConstructorHelpers.h"
+#include "Kismet/KismetSystemLibrary.h"
 
 URTSCamera::URTSCamera()
 {
+	/** Rigs are updated by URTSCameraSubsystem in one batched pass. The component tick is left to Blueprint subclasses
+	 * that implement Event Tick, BeginPlay enables it for them only and orders it after that pass */
 	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+	PrimaryComponentTick.TickGroup = TG_DuringPhysics;
 	CollisionChannel = ECC_WorldStatic;
 	DragExtent = 0.6f;
 	EdgeScrollSpeed = 50;
@@ -23,45 +29,65 @@ URTSCamera::URTSCamera()
 	EnableCameraRotationLag = true;
 	EnableDynamicCameraHeight = true;
 	EnableEdgeScrolling = true;
+	EnableSignificance = false;
+	EnableSmoothJumps = true;
+	SmoothingMode = ERTSCameraSmoothingMode::ExponentialDecay;
+	TurnCatchupSpeed = 0;
+	FollowGroupAdjustsZoom = true;
+	FollowGroupFraming = 1.1f;
+	FollowGroupSmoothing = 3.0f;
 	FindGroundTraceLength = 100000;
 	MaximumZoomLength = 5000;
 	MinimumZoomLength = 500;
 	MoveSpeed = 50;
 	RotateAngle = 45;
+	SignificanceFootprintMaxDistance = 20000;
+	SignificanceUpdateBudget = 256;
 	StartingYAngle = -45.0f;
 	StartingZAngle = 0;
 	StartingLenght = 400.0f;
 	ZoomCatchupSpeed = 4;
 	ZoomSpeed = -200;
-
-	/** this is not really needed but preloads the assets into the defaults section of children */
-	static ConstructorHelpers::FObjectFinder<UInputAction>
-		MoveCameraXAxisFinder(TEXT("/OpenRTSCamera/Inputs/MoveCameraXAxis"));
-	static ConstructorHelpers::FObjectFinder<UInputAction>
-		MoveCameraYAxisFinder(TEXT("/OpenRTSCamera/Inputs/MoveCameraYAxis"));
-	static ConstructorHelpers::FObjectFinder<UInputAction>
-		TurnCameraLeftFinder(TEXT("/OpenRTSCamera/Inputs/TurnCameraLeft"));
-	static ConstructorHelpers::FObjectFinder<UInputAction>
-		TurnCameraRightFinder(TEXT("/OpenRTSCamera/Inputs/TurnCameraRight"));
-	static ConstructorHelpers::FObjectFinder<UInputAction>
-		ZoomCameraFinder(TEXT("/OpenRTSCamera/Inputs/ZoomCamera"));
-	static ConstructorHelpers::FObjectFinder<UInputAction>
-		DragCameraFinder(TEXT("/OpenRTSCamera/Inputs/DragCamera"));
-	static ConstructorHelpers::FObjectFinder<UInputMappingContext>
-		InputMappingContextFinder(TEXT("/OpenRTSCamera/Inputs/OpenRTSCameraInputs"));
-
-	MoveCameraXAxis = MoveCameraXAxisFinder.Object;
-	MoveCameraYAxis = MoveCameraYAxisFinder.Object;
-	TurnCameraLeft = TurnCameraLeftFinder.Object;
-	TurnCameraRight = TurnCameraRightFinder.Object;
-	DragCamera = DragCameraFinder.Object;
-	ZoomCamera = ZoomCameraFinder.Object;
-	InputMappingContext = InputMappingContextFinder.Object;
+	ZoomedOutSignificanceLength = 4000;
+
+	/** Full rate on screen, then progressively cheaper the further a unit is from what the camera looks at */
+	SignificanceBuckets.SetNum(4);
+	SignificanceBuckets[1].MaxDistance = 2000;
+	SignificanceBuckets[1].ActorTickInterval = 0.1f;
+	SignificanceBuckets[1].AnimationTickInterval = 0.066f;
+	SignificanceBuckets[1].EffectsTickInterval = 0.1f;
+	SignificanceBuckets[2].MaxDistance = 6000;
+	SignificanceBuckets[2].ActorTickInterval = 0.5f;
+	SignificanceBuckets[2].AnimationTickInterval = 0.25f;
+	SignificanceBuckets[2].EffectsTickInterval = 0.5f;
+	SignificanceBuckets[2].bShowWidgets = false;
+	SignificanceBuckets[3].ActorTickInterval = 1.0f;
+	SignificanceBuckets[3].AnimationTickInterval = 1.0f;
+	SignificanceBuckets[3].EffectsTickInterval = 1.0f;
+	SignificanceBuckets[3].bShowWidgets = false;
+
+	/** Only the paths, the assets are streamed in on BeginPlay so loading the class never loads them */
+	MoveCameraXAxis = TSoftObjectPtr<UInputAction>(FSoftObjectPath(TEXT("/OpenRTSCamera/Inputs/MoveCameraXAxis.MoveCameraXAxis")));
+	MoveCameraYAxis = TSoftObjectPtr<UInputAction>(FSoftObjectPath(TEXT("/OpenRTSCamera/Inputs/MoveCameraYAxis.MoveCameraYAxis")));
+	TurnCameraLeft = TSoftObjectPtr<UInputAction>(FSoftObjectPath(TEXT("/OpenRTSCamera/Inputs/TurnCameraLeft.TurnCameraLeft")));
+	TurnCameraRight = TSoftObjectPtr<UInputAction>(FSoftObjectPath(TEXT("/OpenRTSCamera/Inputs/TurnCameraRight.TurnCameraRight")));
+	ZoomCamera = TSoftObjectPtr<UInputAction>(FSoftObjectPath(TEXT("/OpenRTSCamera/Inputs/ZoomCamera.ZoomCamera")));
+	DragCamera = TSoftObjectPtr<UInputAction>(FSoftObjectPath(TEXT("/OpenRTSCamera/Inputs/DragCamera.DragCamera")));
+	InputMappingContext = TSoftObjectPtr<UInputMappingContext>(FSoftObjectPath(TEXT("/OpenRTSCamera/Inputs/OpenRTSCameraInputs.OpenRTSCameraInputs")));
 }
 
 void URTSCamera::BeginPlay()
 {
 	Super::BeginPlay();
+	if (GetClass()->IsFunctionImplementedInScript(GET_FUNCTION_NAME_CHECKED(URTSCamera, ReceiveTick)))
+	{
+		if (const auto Subsystem = GetWorld()->GetSubsystem<URTSCameraSubsystem>())
+		{
+			PrimaryComponentTick.AddPrerequisite(Subsystem, Subsystem->GetTickFunction());
+		}
+		SetComponentTickEnabled(true);
+	}
+
 	if (const auto NetMode = GetNetMode() != NM_DedicatedServer)
 	{
 		/** Populate references we need + setup the desired original position */
@@ -73,36 +99,136 @@ void URTSCamera::BeginPlay()
 		
 		ConditionallyEnableEdgeScrolling();
 		CheckForEnhancedInputComponent();
-		BindInputMappingContext();
-		BindInputActions();
+		RequestInputAssets();
+
+		if (EnableSignificance && Significance)
+		{
+			Significance->Configure(SignificanceBuckets, ZoomedOutSignificanceLength, SignificanceUpdateBudget);
+		}
+
+		if (const auto Pawn = Cast<APawn>(Owner))
+		{
+			Pawn->ReceiveControllerChangedDelegate.AddDynamic(this, &URTSCamera::OnOwnerControllerChanged);
+		}
+
+		if (CameraSubsystem)
+		{
+			CameraSubsystem->RegisterCamera(this);
+		}
+	}
+}
+
+void URTSCamera::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (CameraSubsystem)
+	{
+		CameraSubsystem->UnregisterCamera(this);
 	}
+	if (InputAssetsHandle)
+	{
+		InputAssetsHandle->CancelHandle();
+		InputAssetsHandle.Reset();
+	}
+	LoadedInputAssets.Reset();
+	ClearFollowGroup();
+	Super::EndPlay(EndPlayReason);
 }
 
-void URTSCamera::TickComponent(const float DeltaTime,const ELevelTick TickType,	FActorComponentTickFunction* ThisTickFunction)
-{	
-	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
-	if (const auto NetMode = GetNetMode()!= NM_DedicatedServer && PlayerController->GetViewTarget() == Owner)
+void URTSCamera::TickRig(const float DeltaTime, const FRTSCameraInputSnapshot& Input)
+{
+	if (PlayerController && PlayerController->GetViewTarget() == Owner)
 	{
 		DeltaSeconds = DeltaTime;
+		InputSnapshot = Input;
 		ApplyMoveCameraCommands();
-		ConditionallyPerformEdgeScrolling();
-		ConditionallyKeepCameraAtDesiredZoomAboveGround();
-		SmoothTargetArmLengthToDesiredZoom();
-		FollowTargetIfSet();
+
+		/** A flight owns position, yaw and zoom until it lands, its height was resolved against the ground up front */
+		if (Transition.IsActive())
+		{
+			AdvanceTransition();
+		}
+		else
+		{
+			ConditionallyPerformEdgeScrolling();
+			ConditionallyKeepCameraAtDesiredZoomAboveGround();
+			FollowTargetIfSet();
+			AdvanceSmoothing();
+		}
 		ConditionallyApplyCameraBounds();
+		ConditionallyReportSignificanceViewpoint();
 	}
 }
 
 void URTSCamera::FollowTarget(AActor* Target)
 {
+	ClearFollowGroup();
 	CameraFollowTarget = Target;
 }
 
 void URTSCamera::UnFollowTarget()
 {
+	ClearFollowGroup();
 	CameraFollowTarget = nullptr;
 }
 
+void URTSCamera::FollowGroup(const TArray<AActor*>& Members)
+{
+	UnFollowTarget();
+
+	for (AActor* Member : Members)
+	{
+		USceneComponent* MemberRoot = IsValid(Member) ? Member->GetRootComponent() : nullptr;
+		if (MemberRoot == nullptr || FollowGroupState.Contains(Member))
+		{
+			continue;
+		}
+
+		FollowGroupMembers.Add(Member);
+		FollowGroupState.Add(Member, MemberRoot->GetComponentLocation());
+		MemberRoot->TransformUpdated.AddUObject(this, &URTSCamera::OnFollowGroupMemberMoved);
+		Member->OnEndPlay.AddDynamic(this, &URTSCamera::OnFollowGroupMemberEndPlay);
+	}
+
+	FollowGroupState.Refresh();
+	SmoothedFollowGroupCenter = FollowGroupState.GetCentroid();
+	SmoothedFollowGroupRadius = FollowGroupState.GetExtentRadius() * FollowGroupFraming;
+	FollowCenterSmoothing.Reset(SmoothedFollowGroupCenter);
+	FollowRadiusSmoothing.Reset(SmoothedFollowGroupRadius);
+}
+
+void URTSCamera::ClearFollowGroup()
+{
+	for (const auto& Member : FollowGroupMembers)
+	{
+		if (AActor* Actor = Member.Get())
+		{
+			if (USceneComponent* MemberRoot = Actor->GetRootComponent())
+			{
+				MemberRoot->TransformUpdated.RemoveAll(this);
+			}
+			Actor->OnEndPlay.RemoveDynamic(this, &URTSCamera::OnFollowGroupMemberEndPlay);
+		}
+	}
+	FollowGroupMembers.Reset();
+	FollowGroupState.Reset();
+}
+
+void URTSCamera::OnFollowGroupMemberMoved(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport)
+{
+	FollowGroupState.Move(UpdatedComponent->GetOwner(), UpdatedComponent->GetComponentLocation());
+}
+
+void URTSCamera::OnFollowGroupMemberEndPlay(AActor* Actor, EEndPlayReason::Type EndPlayReason)
+{
+	if (USceneComponent* MemberRoot = Actor->GetRootComponent())
+	{
+		MemberRoot->TransformUpdated.RemoveAll(this);
+	}
+	Actor->OnEndPlay.RemoveDynamic(this, &URTSCamera::OnFollowGroupMemberEndPlay);
+	FollowGroupMembers.RemoveSwap(Actor, EAllowShrinking::No);
+	FollowGroupState.Remove(Actor);
+}
+
 void URTSCamera::SetCameraZoom(const float NewZoomDistance , const bool bSmoothLerp)
 {
 	if (SpringArm)
@@ -114,29 +240,50 @@ void URTSCamera::SetCameraZoom(const float NewZoomDistance , const bool bSmoothL
 
 void URTSCamera::OnZoomCamera(const FInputActionValue& Value)
 {
+	Transition.Cancel();
 	DesiredZoomLength = FMath::Clamp(DesiredZoomLength + Value.Get<float>() * ZoomSpeed,MinimumZoomLength,MaximumZoomLength);
 }
 
 void URTSCamera::OnRotateCameraLeft(const FInputActionValue& Value)
 {
+	Transition.Cancel();
+	DesiredYaw.Reset();
 	const auto WorldRotation = Root->GetComponentRotation();
 	Root->SetWorldRotation(FRotator::MakeFromEuler(FVector(WorldRotation.Euler().X,	WorldRotation.Euler().Y,WorldRotation.Euler().Z -  Value.Get<float>())));
 }
 
 void URTSCamera::OnRotateCameraRight(const FInputActionValue& Value)
 {
+	Transition.Cancel();
+	DesiredYaw.Reset();
 	const auto WorldRotation = Root->GetComponentRotation();
 	Root->SetWorldRotation(FRotator::MakeFromEuler(FVector(WorldRotation.Euler().X,	WorldRotation.Euler().Y,WorldRotation.Euler().Z +  Value.Get<float>())));
 }
 
 void URTSCamera::OnTurnCameraLeft(const FInputActionValue& Value)
 {
+	Transition.Cancel();
+	if (TurnCatchupSpeed > 0)
+	{
+		/** Repeated taps stack on the yaw we are already easing toward */
+		DesiredYaw = DesiredYaw.Get(Root->GetComponentRotation().Yaw) - RotateAngle;
+		return;
+	}
+
 	const auto WorldRotation = Root->GetRelativeRotation();
 	Root->SetRelativeRotation(FRotator::MakeFromEuler(FVector(WorldRotation.Euler().X,WorldRotation.Euler().Y,WorldRotation.Euler().Z - RotateAngle)));	
 }
 
 void URTSCamera::OnTurnCameraRight(const FInputActionValue& Value)
 {
+	Transition.Cancel();
+	if (TurnCatchupSpeed > 0)
+	{
+		/** Repeated taps stack on the yaw we are already easing toward */
+		DesiredYaw = DesiredYaw.Get(Root->GetComponentRotation().Yaw) + RotateAngle;
+		return;
+	}
+
 	const auto WorldRotation = Root->GetRelativeRotation();
 	Root->SetRelativeRotation(FRotator::MakeFromEuler(FVector(WorldRotation.Euler().X,WorldRotation.Euler().Y,WorldRotation.Euler().Z + RotateAngle)));	
 }
@@ -161,33 +308,30 @@ void URTSCamera::OnMoveCameraXAxis(const FInputActionValue& Value)
 
 void URTSCamera::OnDragCamera(const FInputActionValue& Value)
 {
+	if (!InputSnapshot.bHasMouse)
+	{
+		return;
+	}
+
 	if (!IsDragging && Value.Get<bool>())
 	{
 		IsDragging = true;
-		DragStartLocation = UWidgetLayoutLibrary::GetMousePositionOnViewport(GetWorld());
+		DragStartLocation = InputSnapshot.MousePosition;
 	}
 
 	else if (IsDragging && Value.Get<bool>())
 	{
-		const auto MousePosition = UWidgetLayoutLibrary::GetMousePositionOnViewport(GetWorld());
-		auto DragExtents = UWidgetLayoutLibrary::GetViewportWidgetGeometry(GetWorld()).GetLocalSize();
+		const auto MousePosition = InputSnapshot.MousePosition;
+		auto DragExtents = InputSnapshot.ViewportSize;
 		DragExtents *= DragExtent;
 
 		auto Delta = MousePosition - DragStartLocation;
 		Delta.X = FMath::Clamp(Delta.X, -DragExtents.X, DragExtents.X) / DragExtents.X;
 		Delta.Y = FMath::Clamp(Delta.Y, -DragExtents.Y, DragExtents.Y) / DragExtents.Y;
 
-		RequestMoveCamera(
-			SpringArm->GetRightVector().X,
-			SpringArm->GetRightVector().Y,
-			Delta.X
-		);
-
-		RequestMoveCamera(
-			SpringArm->GetForwardVector().X,
-			SpringArm->GetForwardVector().Y,
-			Delta.Y * -1
-		);
+		/** Applied once per tick, however many times Triggered fires in between */
+		PendingDragDelta = Delta;
+		bHasPendingDrag = true;
 	}
 
 	else if (IsDragging && !Value.Get<bool>())
@@ -198,6 +342,11 @@ void URTSCamera::OnDragCamera(const FInputActionValue& Value)
 
 void URTSCamera::RequestMoveCamera(const float X, const float Y, const float Scale)
 {
+	if (Scale != 0)
+	{
+		Transition.Cancel();
+	}
+
 	FMoveCameraCommand MoveCameraCommand;
 	MoveCameraCommand.X = X;
 	MoveCameraCommand.Y = Y;
@@ -207,6 +356,22 @@ void URTSCamera::RequestMoveCamera(const float X, const float Y, const float Sca
 
 void URTSCamera::ApplyMoveCameraCommands()
 {
+	if (bHasPendingDrag)
+	{
+		bHasPendingDrag = false;
+		RequestMoveCamera(
+			SpringArm->GetRightVector().X,
+			SpringArm->GetRightVector().Y,
+			PendingDragDelta.X
+		);
+
+		RequestMoveCamera(
+			SpringArm->GetForwardVector().X,
+			SpringArm->GetForwardVector().Y,
+			PendingDragDelta.Y * -1
+		);
+	}
+
 	for (const auto& [X, Y, Scale] : MoveCameraCommands)
 	{
 		auto Movement = FVector2D(X, Y);
@@ -224,10 +389,49 @@ void URTSCamera::CollectComponentDependencyReferences()
 	Root = Owner->GetRootComponent();
 	Camera = Cast<UCameraComponent>(Owner->GetComponentByClass(UCameraComponent::StaticClass()));
 	SpringArm = Cast<USpringArmComponent>(Owner->GetComponentByClass(USpringArmComponent::StaticClass()));
-	PlayerController = UGameplayStatics::GetPlayerController(GetWorld(), 0);
+	PlayerController = ResolvePlayerController();
+	Significance = GetWorld()->GetSubsystem<URTSSignificanceSubsystem>();
+	CameraSubsystem = GetWorld()->GetSubsystem<URTSCameraSubsystem>();
 	TryToFindBoundaryVolumeReference();
 }
 
+APlayerController* URTSCamera::ResolvePlayerController() const
+{
+	/** Rigs of other players' pawns (a listen server or client sees all of them) have no controller of ours to read or
+	 * project through, they are driven by replication */
+	if (const auto Pawn = Cast<APawn>(Owner))
+	{
+		return Pawn->IsLocallyControlled() ? Pawn->GetController<APlayerController>() : nullptr;
+	}
+	return UGameplayStatics::GetPlayerController(GetWorld(), 0);
+}
+
+void URTSCamera::OnOwnerControllerChanged(APawn* Pawn, AController* OldController, AController* NewController)
+{
+	const auto NewPlayerController = ResolvePlayerController();
+	if (NewPlayerController == PlayerController)
+	{
+		return;
+	}
+
+	/** Move our bindings over to the controller that now drives this rig */
+	if (PlayerController)
+	{
+		if (const auto EnhancedInputComponent = Cast<UEnhancedInputComponent>(PlayerController->InputComponent))
+		{
+			EnhancedInputComponent->ClearBindingsForObject(this);
+		}
+	}
+
+	PlayerController = NewPlayerController;
+	IsDragging = false;
+	if (PlayerController)
+	{
+		ConditionallyEnableEdgeScrolling();
+		RequestInputAssets();
+	}
+}
+
 void URTSCamera::SetCameraStartingTransform()
 {
 	if (SpringArm)
@@ -262,7 +466,7 @@ void URTSCamera::TryToFindBoundaryVolumeReference()
 
 void URTSCamera::ConditionallyEnableEdgeScrolling() const
 {
-	if (EnableEdgeScrolling)
+	if (EnableEdgeScrolling && PlayerController)
 	{
 		FInputModeGameAndUI InputMode;
 		InputMode.SetLockMouseToViewportBehavior(EMouseLockMode::LockAlways);
@@ -273,7 +477,7 @@ void URTSCamera::ConditionallyEnableEdgeScrolling() const
 
 void URTSCamera::CheckForEnhancedInputComponent() const
 {
-	if (Cast<UEnhancedInputComponent>(PlayerController->InputComponent) == nullptr)
+	if (PlayerController && Cast<UEnhancedInputComponent>(PlayerController->InputComponent) == nullptr)
 	{
 		UKismetSystemLibrary::PrintString(
 			GetWorld(),
@@ -307,9 +511,9 @@ void URTSCamera::BindInputMappingContext() const
 			PlayerController->bShowMouseCursor = true;
 
 			// Check if the context is already bound to prevent double binding
-			if (!Input->HasMappingContext(InputMappingContext))
+			if (!Input->HasMappingContext(InputMappingContext.Get()))
 			{
-				Input->AddMappingContext(InputMappingContext, 0);
+				Input->AddMappingContext(InputMappingContext.Get(), 0);
 			}
 		}
 	}
@@ -319,40 +523,204 @@ void URTSCamera::BindInputActions()
 {
 	if (const auto EnhancedInputComponent = Cast<UEnhancedInputComponent>(PlayerController->InputComponent))
 	{
-		EnhancedInputComponent->BindAction(ZoomCamera, ETriggerEvent::Triggered,this,&URTSCamera::OnZoomCamera);
-		EnhancedInputComponent->BindAction(TurnCameraLeft,ETriggerEvent::Triggered,this,&URTSCamera::OnRotateCameraLeft);
-		EnhancedInputComponent->BindAction(TurnCameraRight,ETriggerEvent::Triggered,this,&URTSCamera::OnRotateCameraRight);
+		EnhancedInputComponent->BindAction(ZoomCamera.Get(), ETriggerEvent::Triggered,this,&URTSCamera::OnZoomCamera);
+		EnhancedInputComponent->BindAction(TurnCameraLeft.Get(),ETriggerEvent::Triggered,this,&URTSCamera::OnRotateCameraLeft);
+		EnhancedInputComponent->BindAction(TurnCameraRight.Get(),ETriggerEvent::Triggered,this,&URTSCamera::OnRotateCameraRight);
 
 		if (bUseIncrementalRotation)
 		{
-			EnhancedInputComponent->BindAction(TurnCameraLeft,ETriggerEvent::Canceled,this,	&URTSCamera::OnTurnCameraLeft);
-			EnhancedInputComponent->BindAction(TurnCameraRight,ETriggerEvent::Canceled,this,&URTSCamera::OnTurnCameraRight);
+			EnhancedInputComponent->BindAction(TurnCameraLeft.Get(),ETriggerEvent::Canceled,this,	&URTSCamera::OnTurnCameraLeft);
+			EnhancedInputComponent->BindAction(TurnCameraRight.Get(),ETriggerEvent::Canceled,this,&URTSCamera::OnTurnCameraRight);
 		}
 
-		EnhancedInputComponent->BindAction(MoveCameraXAxis,ETriggerEvent::Triggered,this,&URTSCamera::OnMoveCameraXAxis);
-		EnhancedInputComponent->BindAction(MoveCameraYAxis,ETriggerEvent::Triggered,this,&URTSCamera::OnMoveCameraYAxis);
-		EnhancedInputComponent->BindAction(DragCamera,ETriggerEvent::Triggered,this,&URTSCamera::OnDragCamera);
+		EnhancedInputComponent->BindAction(MoveCameraXAxis.Get(),ETriggerEvent::Triggered,this,&URTSCamera::OnMoveCameraXAxis);
+		EnhancedInputComponent->BindAction(MoveCameraYAxis.Get(),ETriggerEvent::Triggered,this,&URTSCamera::OnMoveCameraYAxis);
+		EnhancedInputComponent->BindAction(DragCamera.Get(),ETriggerEvent::Triggered,this,&URTSCamera::OnDragCamera);
+	}
+}
+
+void URTSCamera::RequestInputAssets()
+{
+	/** Already streaming, the callback binds to whichever controller we have by then */
+	if (InputAssetsHandle && InputAssetsHandle->IsLoadingInProgress())
+	{
+		return;
+	}
+
+	TArray<FSoftObjectPath> Pending;
+	for (const FSoftObjectPath& Path : {
+		     InputMappingContext.ToSoftObjectPath(), TurnCameraLeft.ToSoftObjectPath(), TurnCameraRight.ToSoftObjectPath(),
+		     MoveCameraYAxis.ToSoftObjectPath(), MoveCameraXAxis.ToSoftObjectPath(), DragCamera.ToSoftObjectPath(),
+		     ZoomCamera.ToSoftObjectPath()
+	     })
+	{
+		if (!Path.IsNull() && Path.ResolveObject() == nullptr)
+		{
+			Pending.Add(Path);
+		}
+	}
+
+	if (Pending.Num() == 0)
+	{
+		OnInputAssetsLoaded();
+		return;
+	}
+
+	InputAssetsRequestTime = FPlatformTime::Seconds();
+	InputAssetsHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(
+		MoveTemp(Pending), FStreamableDelegate::CreateUObject(this, &URTSCamera::OnInputAssetsLoaded));
+}
+
+void URTSCamera::OnInputAssetsLoaded()
+{
+	if (InputAssetsHandle)
+	{
+		UE_LOG(LogTemp, Verbose, TEXT("URTSCamera: input assets streamed in %.2f ms"),
+		       (FPlatformTime::Seconds() - InputAssetsRequestTime) * 1000.0);
+		InputAssetsHandle.Reset();
+	}
+
+	LoadedInputAssets = {InputMappingContext.Get(), TurnCameraLeft.Get(), TurnCameraRight.Get(), MoveCameraYAxis.Get(), MoveCameraXAxis.Get(), DragCamera.Get(), ZoomCamera.Get()};
+	LoadedInputAssets.Remove(nullptr);
+
+	if (PlayerController)
+	{
+		BindInputMappingContext();
+		BindInputActions();
 	}
 }
 
 void URTSCamera::SetActiveCamera() const
 {
-	PlayerController->SetViewTarget(GetOwner());
+	if (PlayerController)
+	{
+		PlayerController->SetViewTarget(GetOwner());
+	}
+}
+
+void URTSCamera::JumpTo(const FVector Position)
+{
+	FRTSCameraBookmark Destination = GetCurrentView();
+	Destination.Location = Position;
+	StartTransition(Destination);
+}
+
+void URTSCamera::JumpTo(const AActor* Actor)
+{
+	JumpTo(Actor->GetActorLocation());
+}
+
+void URTSCamera::CancelJump()
+{
+	Transition.Cancel();
+}
+
+void URTSCamera::SaveBookmark(const FName Name)
+{
+	Bookmarks.Add(Name, GetCurrentView());
+}
+
+bool URTSCamera::JumpToBookmark(const FName Name)
+{
+	const auto Bookmark = Bookmarks.Find(Name);
+	if (Bookmark == nullptr)
+	{
+		return false;
+	}
+
+	StartTransition(*Bookmark);
+	return true;
+}
+
+void URTSCamera::RemoveBookmark(const FName Name)
+{
+	Bookmarks.Remove(Name);
+}
+
+FRTSCameraBookmark URTSCamera::GetCurrentView() const
+{
+	FRTSCameraBookmark View;
+	if (Root)
+	{
+		View.Location = Root->GetComponentLocation();
+		View.Yaw = Root->GetComponentRotation().Yaw;
+	}
+	View.Zoom = DesiredZoomLength;
+	return View;
+}
+
+void URTSCamera::StartTransition(FRTSCameraBookmark Destination)
+{
+	if (Root == nullptr || SpringArm == nullptr)
+	{
+		return;
+	}
+
+	UnFollowTarget();
+	Destination.Location = ClampToBounds(Destination.Location);
+	Destination.Zoom = FMath::Clamp(Destination.Zoom, MinimumZoomLength, MaximumZoomLength);
+
+	/** One ground lookup for the landing spot, the flight interpolates the height in between */
+	float GroundHeight;
+	if (EnableDynamicCameraHeight && CameraSubsystem && CameraSubsystem->GetGroundHeight(Destination.Location, FindGroundTraceLength, GroundHeight))
+	{
+		Destination.Location.Z = GroundHeight;
+	}
+
+	if (!EnableSmoothJumps)
+	{
+		Transition.Cancel();
+		ApplyView(Destination);
+		return;
+	}
+
+	FRTSCameraBookmark Origin = GetCurrentView();
+	Origin.Zoom = SpringArm->TargetArmLength;
+	Transition.Start(Origin, Destination, JumpTransition, MaximumZoomLength);
+
+	/** No flight to play (no MinDuration and a destination straight below or above), land right away */
+	if (!Transition.IsActive())
+	{
+		ApplyView(Destination);
+	}
+}
+
+void URTSCamera::AdvanceTransition()
+{
+	FRTSCameraBookmark View;
+	Transition.Advance(DeltaSeconds, View);
+	ApplyView(View);
+}
+
+void URTSCamera::ApplyView(const FRTSCameraBookmark& View)
+{
+	const auto Rotation = Root->GetComponentRotation();
+	Root->SetWorldLocationAndRotation(View.Location, FRotator(Rotation.Pitch, View.Yaw, Rotation.Roll));
+
+	/** The zoom bump can go past the maximum on purpose, only the resting zoom is clamped */
+	DesiredZoomLength = FMath::Clamp(View.Zoom, MinimumZoomLength, MaximumZoomLength);
+	SpringArm->TargetArmLength = View.Zoom;
+
+	/** Smoothing picks up from here once the flight is over, without the velocity it had before */
+	DesiredYaw.Reset();
+	ZoomSmoothing.Reset(DesiredZoomLength);
+	YawSmoothing.Reset(View.Yaw);
+	HeightSmoothing.Reset(View.Location.Z);
 }
 
-void URTSCamera::JumpTo(const FVector Position) const
+float URTSCamera::GetZoomLength() const
 {
-	Root->SetWorldLocation(Position);
+	return SpringArm ? SpringArm->TargetArmLength : 0.0f;
 }
 
-void URTSCamera::JumpTo(const AActor* Actor) const
+FRTSCursorGroundHit URTSCamera::GetCursorGroundHit() const
 {
-	Root->SetWorldLocation(Actor->GetActorLocation());
+	return CameraSubsystem ? CameraSubsystem->GetCursorGroundHit(PlayerController) : FRTSCursorGroundHit();
 }
 
 void URTSCamera::ConditionallyPerformEdgeScrolling() const
 {
-	if (EnableEdgeScrolling && !IsDragging)
+	if (EnableEdgeScrolling && !IsDragging && InputSnapshot.bHasMouse)
 	{
 		EdgeScrollLeft();
 		EdgeScrollRight();
@@ -363,8 +731,8 @@ void URTSCamera::ConditionallyPerformEdgeScrolling() const
 
 void URTSCamera::EdgeScrollLeft() const
 {
-	const auto MousePosition = UWidgetLayoutLibrary::GetMousePositionOnViewport(GetWorld());
-	const auto ViewportSize = UWidgetLayoutLibrary::GetViewportWidgetGeometry(GetWorld()).GetLocalSize();
+	const auto MousePosition = InputSnapshot.MousePosition;
+	const auto ViewportSize = InputSnapshot.ViewportSize;
 	const auto NormalizedMousePosition = 1 - UKismetMathLibrary::NormalizeToRange(MousePosition.X,0.0f,ViewportSize.X * DistanceFromEdgeThreshold);
 
 	const auto Movement = UKismetMathLibrary::FClamp(NormalizedMousePosition, 0.0, 1.0);
@@ -373,8 +741,8 @@ void URTSCamera::EdgeScrollLeft() const
 
 void URTSCamera::EdgeScrollRight() const
 {
-	const auto MousePosition = UWidgetLayoutLibrary::GetMousePositionOnViewport(GetWorld());
-	const auto ViewportSize = UWidgetLayoutLibrary::GetViewportWidgetGeometry(GetWorld()).GetLocalSize();
+	const auto MousePosition = InputSnapshot.MousePosition;
+	const auto ViewportSize = InputSnapshot.ViewportSize;
 	const auto NormalizedMousePosition = UKismetMathLibrary::NormalizeToRange(MousePosition.X,ViewportSize.X * (1 - DistanceFromEdgeThreshold),	ViewportSize.X	);
 
 	const auto Movement = UKismetMathLibrary::FClamp(NormalizedMousePosition, 0.0, 1.0);
@@ -383,8 +751,8 @@ void URTSCamera::EdgeScrollRight() const
 
 void URTSCamera::EdgeScrollUp() const
 {
-	const auto MousePosition = UWidgetLayoutLibrary::GetMousePositionOnViewport(GetWorld());
-	const auto ViewportSize = UWidgetLayoutLibrary::GetViewportWidgetGeometry(GetWorld()).GetLocalSize();
+	const auto MousePosition = InputSnapshot.MousePosition;
+	const auto ViewportSize = InputSnapshot.ViewportSize;
 	const auto NormalizedMousePosition = UKismetMathLibrary::NormalizeToRange(MousePosition.Y,	0.0f,ViewportSize.Y * DistanceFromEdgeThreshold);
 
 	const auto Movement = 1 - UKismetMathLibrary::FClamp(NormalizedMousePosition, 0.0, 1.0);
@@ -393,8 +761,8 @@ void URTSCamera::EdgeScrollUp() const
 
 void URTSCamera::EdgeScrollDown() const
 {
-	const auto MousePosition = UWidgetLayoutLibrary::GetMousePositionOnViewport(GetWorld());
-	const auto ViewportSize = UWidgetLayoutLibrary::GetViewportWidgetGeometry(GetWorld()).GetLocalSize();
+	const auto MousePosition = InputSnapshot.MousePosition;
+	const auto ViewportSize = InputSnapshot.ViewportSize;
 	const auto NormalizedMousePosition = UKismetMathLibrary::NormalizeToRange(MousePosition.Y,ViewportSize.Y * (1 - DistanceFromEdgeThreshold),ViewportSize.Y);
 
 	const auto Movement = UKismetMathLibrary::FClamp(NormalizedMousePosition, 0.0, 1.0);
@@ -410,58 +778,119 @@ void URTSCamera::FollowTargetIfSet() const
 	}
 }
 
-void URTSCamera::SmoothTargetArmLengthToDesiredZoom() const
+void URTSCamera::AdvanceSmoothing()
 {
-	SpringArm->TargetArmLength = FMath::FInterpTo(SpringArm->TargetArmLength,DesiredZoomLength,DeltaSeconds,ZoomCatchupSpeed);
-}
+	/** Every quantity the rig eases toward is solved here, in one pass, with exact decay so the feel does not depend on the frame rate */
+	if (FollowGroupState.Num() > 0)
+	{
+		FollowGroupState.Refresh();
+		const float Radius = FollowGroupState.GetExtentRadius() * FollowGroupFraming;
+		SmoothedFollowGroupCenter = FollowCenterSmoothing.Advance(SmoothedFollowGroupCenter, FollowGroupState.GetCentroid(), FollowGroupSmoothing, DeltaSeconds, SmoothingMode);
+		SmoothedFollowGroupRadius = FollowRadiusSmoothing.Advance(SmoothedFollowGroupRadius, Radius, FollowGroupSmoothing, DeltaSeconds, SmoothingMode);
+		Root->SetWorldLocation(SmoothedFollowGroupCenter);
+
+		/** Pull back until a circle of the framing radius around the center fits in the narrower half of the view */
+		if (FollowGroupAdjustsZoom && Camera)
+		{
+			const float HalfFieldOfView = FMath::DegreesToRadians(FMath::Clamp(Camera->FieldOfView, 1.0f, 170.0f) * 0.5f);
+			const float AspectRatio = InputSnapshot.ViewportSize.X > 0 && InputSnapshot.ViewportSize.Y > 0 ? InputSnapshot.ViewportSize.X / InputSnapshot.ViewportSize.Y : Camera->AspectRatio;
+			const float NarrowHalfTangent = FMath::Tan(HalfFieldOfView) * FMath::Min(1.0f, 1.0f / AspectRatio);
+			DesiredZoomLength = FMath::Clamp(SmoothedFollowGroupRadius / NarrowHalfTangent, MinimumZoomLength, MaximumZoomLength);
+		}
+	}
+	else if (GroundHeightTarget.IsSet())
+	{
+		FVector Location = Root->GetComponentLocation();
+		Location.Z = HeightSmoothing.Advance(Location.Z, GroundHeightTarget.GetValue(), ZoomCatchupSpeed, DeltaSeconds, SmoothingMode);
+		Root->SetWorldLocation(Location);
+	}
 
-void URTSCamera::ConditionallyKeepCameraAtDesiredZoomAboveGround()
-{
-	if (EnableDynamicCameraHeight)
+	if (DesiredYaw.IsSet())
 	{
-		const auto RootWorldLocation = Root->GetComponentLocation();
-		const TArray<AActor*> ActorsToIgnore;
+		/** Ease along the shortest way around */
+		const FRotator Rotation = Root->GetComponentRotation();
+		const float Target = Rotation.Yaw + FRotator::NormalizeAxis(DesiredYaw.GetValue() - Rotation.Yaw);
+
+		/** The rotation comes back normalized, so a turn across +-180 moves the target by 360. Keep the last target on
+		 * the same turn or long frames sub-step the whole way round */
+		YawSmoothing.PreviousTarget = Target + FRotator::NormalizeAxis(YawSmoothing.PreviousTarget - Target);
+		const float Yaw = YawSmoothing.Advance(Rotation.Yaw, Target, TurnCatchupSpeed, DeltaSeconds, SmoothingMode);
+		Root->SetWorldRotation(FRotator(Rotation.Pitch, Yaw, Rotation.Roll));
+		if (FMath::IsNearlyEqual(Yaw, Target, 0.01f))
+		{
+			DesiredYaw.Reset();
+			YawSmoothing.Reset(Target);
+		}
+	}
 
-		FHitResult HitResult;
-		// Define the object types to detect (Terrain)
-		TArray<TEnumAsByte<EObjectTypeQuery>> ObjectTypes;
-		ObjectTypes.Add(UEngineTypes::ConvertToObjectType(ECC_GameTraceChannel2)); // Adjust to your "Terrain" channel
+	SpringArm->TargetArmLength = ZoomSmoothing.Advance(SpringArm->TargetArmLength, DesiredZoomLength, ZoomCatchupSpeed, DeltaSeconds, SmoothingMode);
+}
 
+void URTSCamera::ConditionallyKeepCameraAtDesiredZoomAboveGround()
+{
+	GroundHeightTarget.Reset();
 
-		const bool bDidHit = UKismetSystemLibrary::LineTraceSingleForObjects(
-			GetWorld(),
-			FVector(RootWorldLocation.X, RootWorldLocation.Y, RootWorldLocation.Z + FindGroundTraceLength),
-			FVector(RootWorldLocation.X, RootWorldLocation.Y, RootWorldLocation.Z - FindGroundTraceLength),
-			ObjectTypes,
-			true,  // Trace complex
-			ActorsToIgnore,
-			EDrawDebugTrace::ForOneFrame,
-			HitResult,
-			true   // Ignore self
-		);
-		
-		if (bDidHit)
+	/** Followed targets own the height of the rig */
+	if (EnableDynamicCameraHeight && CameraSubsystem && CameraFollowTarget == nullptr && FollowGroupState.Num() == 0)
+	{
+		/** Ground heights are shared between every rig of the world, we only trace cells nobody has sampled recently */
+		float GroundHeight;
+		if (CameraSubsystem->GetGroundHeight(Root->GetComponentLocation(), FindGroundTraceLength, GroundHeight))
 		{
-			const FVector TargetLocation = FVector(HitResult.Location.X, HitResult.Location.Y, HitResult.Location.Z);
-			const FVector SmoothedLocation = FMath::VInterpTo(RootWorldLocation, TargetLocation, DeltaSeconds, ZoomCatchupSpeed);
-			Root->SetWorldLocation(SmoothedLocation);
+			GroundHeightTarget = GroundHeight;
 		}
 	}
+
+	if (!GroundHeightTarget.IsSet())
+	{
+		HeightSmoothing.Reset(Root->GetComponentLocation().Z);
+	}
 }
 
 void URTSCamera::ConditionallyApplyCameraBounds() const
 {
 	if (BoundaryVolume != nullptr)
 	{
-		const auto RootWorldLocation = Root->GetComponentLocation();
-		FVector Origin;
-		FVector Extents;
-		BoundaryVolume->GetActorBounds(false, Origin, Extents);
-		Root->SetWorldLocation(FVector(
-				UKismetMathLibrary::Clamp(RootWorldLocation.X, Origin.X - Extents.X, Origin.X + Extents.X),
-				UKismetMathLibrary::Clamp(RootWorldLocation.Y, Origin.Y - Extents.Y, Origin.Y + Extents.Y),
-				RootWorldLocation.Z
-			)
-		);
+		Root->SetWorldLocation(ClampToBounds(Root->GetComponentLocation()));
+	}
+}
+
+FVector URTSCamera::ClampToBounds(const FVector& Location) const
+{
+	if (BoundaryVolume == nullptr)
+	{
+		return Location;
+	}
+
+	FVector Origin;
+	FVector Extents;
+	BoundaryVolume->GetActorBounds(false, Origin, Extents);
+	return FVector(
+		FMath::Clamp(Location.X, Origin.X - Extents.X, Origin.X + Extents.X),
+		FMath::Clamp(Location.Y, Origin.Y - Extents.Y, Origin.Y + Extents.Y),
+		Location.Z
+	);
+}
+
+void URTSCamera::ConditionallyReportSignificanceViewpoint() const
+{
+	FRTSScreenProjector Projector;
+	if (!EnableSignificance || Significance == nullptr || !Projector.Initialize(PlayerController))
+	{
+		return;
+	}
+
+	/** The circle around the ground the view corners see. A tilted view sees much more ground ahead of the rig than
+	 * behind it, so the footprint is not centered on the rig */
+	FVector Corners[4];
+	Projector.DeprojectViewToHeight(Root->GetComponentLocation().Z, SignificanceFootprintMaxDistance, Corners);
+
+	FRTSSignificanceViewpoint Viewpoint;
+	Viewpoint.FootprintCenter = (Corners[0] + Corners[1] + Corners[2] + Corners[3]) * 0.25;
+	for (const FVector& Corner : Corners)
+	{
+		Viewpoint.FootprintRadius = FMath::Max(Viewpoint.FootprintRadius, static_cast<float>(FVector::Dist2D(Corner, Viewpoint.FootprintCenter)));
 	}
+	Viewpoint.ZoomLength = SpringArm->TargetArmLength;
+	Significance->ReportViewpoint(Viewpoint);
 }
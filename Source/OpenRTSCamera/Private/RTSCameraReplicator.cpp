@@ -0,0 +1,406 @@
+// Copyright 2024 Jesus Bracho All Rights Reserved.
+
+#include "RTSCameraReplicator.h"
+
+#include "RTSCameraStats.h"
+#include "RTSCameraSubsystem.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/SpringArmComponent.h"
+#include "Net/UnrealNetwork.h"
+#include "Serialization/BitReader.h"
+#include "Serialization/BitWriter.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Camera Replication Bytes"), STAT_RTSCameraReplicationBytes, STATGROUP_OpenRTSCamera);
+
+namespace RTSCameraReplication
+{
+	/** Deltas bigger than this are not worth it anymore, a new keyframe is sent instead */
+	constexpr int32 MaxDeltaBytes = 8;
+
+	/** Upper bound of the arm length steps, keeps the absolute encoding bounded */
+	constexpr uint32 MaxZoomSteps = 1 << 16;
+
+	uint32 ZigZag(const int32 Value)
+	{
+		return (static_cast<uint32>(Value) << 1) ^ static_cast<uint32>(Value >> 31);
+	}
+
+	int32 UnZigZag(const uint32 Value)
+	{
+		return static_cast<int32>((Value >> 1) ^ (0u - (Value & 1)));
+	}
+
+	void SerializeSigned(FArchive& Ar, int32& Value)
+	{
+		uint32 Encoded = ZigZag(Value);
+		Ar.SerializeIntPacked(Encoded);
+		Value = UnZigZag(Encoded);
+	}
+
+	/** Shortest signed distance between two yaw steps, yaw wraps around */
+	int32 YawDelta(const uint32 From, const uint32 To)
+	{
+		constexpr int32 Steps = FRTSCameraStateCodec::YawSteps;
+		int32 Delta = static_cast<int32>(To) - static_cast<int32>(From);
+		if (Delta >= Steps / 2) Delta -= Steps;
+		if (Delta < -Steps / 2) Delta += Steps;
+		return Delta;
+	}
+
+	void WriteField(FBitWriter& Writer, const int32 Delta)
+	{
+		uint8 bChanged = Delta != 0;
+		Writer.SerializeBits(&bChanged, 1);
+		if (bChanged)
+		{
+			uint32 Encoded = ZigZag(Delta);
+			Writer.SerializeIntPacked(Encoded);
+		}
+	}
+
+	int32 ReadField(FBitReader& Reader)
+	{
+		if (Reader.ReadBit())
+		{
+			uint32 Encoded = 0;
+			Reader.SerializeIntPacked(Encoded);
+			return UnZigZag(Encoded);
+		}
+		return 0;
+	}
+}
+
+bool FRTSQuantizedCameraState::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	RTSCameraReplication::SerializeSigned(Ar, Position.X);
+	RTSCameraReplication::SerializeSigned(Ar, Position.Y);
+	RTSCameraReplication::SerializeSigned(Ar, Position.Z);
+	Ar.SerializeInt(Yaw, FRTSCameraStateCodec::YawSteps);
+	Ar.SerializeInt(Pitch, FRTSCameraStateCodec::PitchSteps);
+	Ar.SerializeInt(Zoom, RTSCameraReplication::MaxZoomSteps);
+	bOutSuccess = !Ar.IsError();
+	return true;
+}
+
+FRTSQuantizedCameraState FRTSCameraStateCodec::Quantize(const FRTSCameraViewState& State)
+{
+	FRTSQuantizedCameraState Quantized;
+	Quantized.Position = FIntVector(
+		FMath::RoundToInt32(State.Location.X / PositionPrecision),
+		FMath::RoundToInt32(State.Location.Y / PositionPrecision),
+		FMath::RoundToInt32(State.Location.Z / PositionPrecision)
+	);
+	Quantized.Yaw = static_cast<uint32>(FMath::RoundToInt32(FRotator::ClampAxis(State.Yaw) / 360.0f * YawSteps)) % YawSteps;
+	Quantized.Pitch = static_cast<uint32>(FMath::Clamp(
+		FMath::RoundToInt32((FRotator::NormalizeAxis(State.Pitch) + 90.0f) / 180.0f * (PitchSteps - 1)), 0, static_cast<int32>(PitchSteps - 1)
+	));
+	Quantized.Zoom = static_cast<uint32>(FMath::Clamp(
+		FMath::RoundToInt32(State.Zoom / ZoomPrecision), 0, static_cast<int32>(RTSCameraReplication::MaxZoomSteps - 1)
+	));
+	return Quantized;
+}
+
+FRTSCameraViewState FRTSCameraStateCodec::Dequantize(const FRTSQuantizedCameraState& State)
+{
+	FRTSCameraViewState ViewState;
+	ViewState.Location = FVector(State.Position) * PositionPrecision;
+	ViewState.Yaw = State.Yaw * 360.0f / YawSteps;
+	ViewState.Pitch = State.Pitch * 180.0f / (PitchSteps - 1) - 90.0f;
+	ViewState.Zoom = State.Zoom * ZoomPrecision;
+	return ViewState;
+}
+
+void FRTSCameraStateCodec::WriteDelta(FBitWriter& Writer, const FRTSQuantizedCameraState& Baseline, const FRTSQuantizedCameraState& State)
+{
+	using namespace RTSCameraReplication;
+	WriteField(Writer, State.Position.X - Baseline.Position.X);
+	WriteField(Writer, State.Position.Y - Baseline.Position.Y);
+	WriteField(Writer, State.Position.Z - Baseline.Position.Z);
+	WriteField(Writer, YawDelta(Baseline.Yaw, State.Yaw));
+	WriteField(Writer, static_cast<int32>(State.Pitch) - static_cast<int32>(Baseline.Pitch));
+	WriteField(Writer, static_cast<int32>(State.Zoom) - static_cast<int32>(Baseline.Zoom));
+}
+
+bool FRTSCameraStateCodec::ReadDelta(FBitReader& Reader, const FRTSQuantizedCameraState& Baseline, FRTSQuantizedCameraState& OutState)
+{
+	using namespace RTSCameraReplication;
+	OutState.Position.X = Baseline.Position.X + ReadField(Reader);
+	OutState.Position.Y = Baseline.Position.Y + ReadField(Reader);
+	OutState.Position.Z = Baseline.Position.Z + ReadField(Reader);
+	OutState.Yaw = static_cast<uint32>(static_cast<int32>(Baseline.Yaw + YawSteps) + ReadField(Reader)) % YawSteps;
+	OutState.Pitch = static_cast<uint32>(FMath::Clamp(static_cast<int32>(Baseline.Pitch) + ReadField(Reader), 0, static_cast<int32>(PitchSteps - 1)));
+	OutState.Zoom = static_cast<uint32>(FMath::Clamp(static_cast<int32>(Baseline.Zoom) + ReadField(Reader), 0, static_cast<int32>(MaxZoomSteps - 1)));
+	return !Reader.IsError();
+}
+
+URTSCameraReplicator::URTSCameraReplicator()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+
+	/** After the camera rigs moved (camera subsystem prerequisite) but before the spring arm resolves the camera (TG_PostPhysics) */
+	PrimaryComponentTick.TickGroup = TG_DuringPhysics;
+	SetIsReplicatedByDefault(true);
+
+	MinSendRate = 2;
+	MaxSendRate = 20;
+	FullRateSpeed = 3000;
+	KeyframeInterval = 2;
+	InterpolationDelay = 0.15f;
+	bDriveRemoteRig = true;
+	Root = nullptr;
+	SpringArm = nullptr;
+}
+
+void URTSCameraReplicator::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	/** The owner already knows where it looks */
+	DOREPLIFETIME_CONDITION(URTSCameraReplicator, ReplicatedState, COND_SkipOwner);
+}
+
+void URTSCameraReplicator::BeginPlay()
+{
+	Super::BeginPlay();
+	Root = GetOwner()->GetRootComponent();
+	SpringArm = GetOwner()->FindComponentByClass<USpringArmComponent>();
+	BytesWindowStart = GetWorld()->GetTimeSeconds();
+
+	/** The rigs update in the same tick group, capture and drive them only once they are done */
+	if (const auto CameraSubsystem = GetWorld()->GetSubsystem<URTSCameraSubsystem>())
+	{
+		PrimaryComponentTick.AddPrerequisite(CameraSubsystem, CameraSubsystem->GetTickFunction());
+	}
+}
+
+void URTSCameraReplicator::TickComponent(const float DeltaTime, const ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+	if (Root == nullptr || SpringArm == nullptr || GetNetMode() == NM_Standalone)
+	{
+		return;
+	}
+
+	if (IsLocallyOwned())
+	{
+		ViewState = CaptureViewState();
+		ConditionallySendState();
+	}
+	else if (GetOwnerRole() != ROLE_Authority)
+	{
+		InterpolateRemoteState();
+	}
+	else if (bDriveRemoteRig && bHasKeyframe && GetNetMode() == NM_ListenServer)
+	{
+		/** A listen server host spectating a client sees the state as it arrives */
+		ApplyViewStateToRig();
+	}
+	CountBytes(0);
+}
+
+bool URTSCameraReplicator::IsLocallyOwned() const
+{
+	const auto Pawn = Cast<APawn>(GetOwner());
+	return Pawn && Pawn->IsLocallyControlled();
+}
+
+FRTSCameraViewState URTSCameraReplicator::CaptureViewState() const
+{
+	FRTSCameraViewState State;
+	State.Location = Root->GetComponentLocation();
+	State.Yaw = Root->GetComponentRotation().Yaw;
+	State.Pitch = SpringArm->GetRelativeRotation().Pitch;
+	State.Zoom = SpringArm->TargetArmLength;
+	return State;
+}
+
+void URTSCameraReplicator::ConditionallySendState()
+{
+	const FRTSQuantizedCameraState State = FRTSCameraStateCodec::Quantize(ViewState);
+	const double Now = GetWorld()->GetTimeSeconds();
+	if (bHasKeyframe && State == LastSentState)
+	{
+		/** Deltas are unreliable, once the camera came to rest make sure spectators get that state with one keyframe */
+		if (State != Keyframe && GetOwnerRole() != ROLE_Authority && Now - LastSendTime >= 1.0f / MinSendRate)
+		{
+			SendKeyframe(State, Now);
+		}
+		return;
+	}
+
+	/** The faster the camera moves, the more often spectators need to hear about it */
+	const double Elapsed = Now - LastSendTime;
+	const float Moved = FVector::Dist(FRTSCameraStateCodec::Dequantize(State).Location, FRTSCameraStateCodec::Dequantize(LastSentState).Location);
+	const float Speed = Elapsed > 0 ? Moved / Elapsed : 0;
+	const float SendRate = FMath::Lerp(MinSendRate, MaxSendRate, FMath::Clamp(Speed / FMath::Max(FullRateSpeed, 1.0f), 0.0f, 1.0f));
+	if (bHasKeyframe && Elapsed < 1.0f / SendRate)
+	{
+		return;
+	}
+
+	LastSendTime = Now;
+	LastSentState = State;
+
+	/** The listen server host owns its camera directly */
+	if (GetOwnerRole() == ROLE_Authority)
+	{
+		bHasKeyframe = true;
+		SetServerState(State);
+		return;
+	}
+
+	FBitWriter Writer(RTSCameraReplication::MaxDeltaBytes * 8, true);
+	FRTSCameraStateCodec::WriteDelta(Writer, Keyframe, State);
+
+	if (!bHasKeyframe || Now - LastKeyframeTime >= KeyframeInterval || Writer.GetNumBytes() > RTSCameraReplication::MaxDeltaBytes)
+	{
+		SendKeyframe(State, Now);
+		return;
+	}
+
+	const TArray<uint8> Payload(Writer.GetData(), Writer.GetNumBytes());
+	ServerReceiveDelta(KeyframeId, Payload);
+	CountBytes(Payload.Num() + 1);
+}
+
+void URTSCameraReplicator::SendKeyframe(const FRTSQuantizedCameraState& State, const double Now)
+{
+	bHasKeyframe = true;
+	LastKeyframeTime = Now;
+	LastSendTime = Now;
+	LastSentState = State;
+	Keyframe = State;
+	++KeyframeId;
+	ServerReceiveKeyframe(KeyframeId, State);
+
+	FBitWriter SizeWriter(0, true);
+	bool bSuccess;
+	Keyframe.NetSerialize(SizeWriter, nullptr, bSuccess);
+	CountBytes(SizeWriter.GetNumBytes() + 1);
+}
+
+void URTSCameraReplicator::ServerReceiveKeyframe_Implementation(const uint8 InKeyframeId, const FRTSQuantizedCameraState& State)
+{
+	KeyframeId = InKeyframeId;
+	Keyframe = State;
+	bHasKeyframe = true;
+	SetServerState(State);
+
+	FBitWriter SizeWriter(0, true);
+	bool bSuccess;
+	Keyframe.NetSerialize(SizeWriter, nullptr, bSuccess);
+	CountBytes(SizeWriter.GetNumBytes() + 1);
+}
+
+void URTSCameraReplicator::ServerReceiveDelta_Implementation(const uint8 InKeyframeId, const TArray<uint8>& Payload)
+{
+	CountBytes(Payload.Num() + 1);
+
+	/** Deltas can overtake the reliable keyframe they reference, those are simply dropped */
+	if (!bHasKeyframe || InKeyframeId != KeyframeId || Payload.Num() > RTSCameraReplication::MaxDeltaBytes)
+	{
+		return;
+	}
+
+	FBitReader Reader(const_cast<uint8*>(Payload.GetData()), Payload.Num() * 8);
+	FRTSQuantizedCameraState State;
+	if (FRTSCameraStateCodec::ReadDelta(Reader, Keyframe, State))
+	{
+		SetServerState(State);
+	}
+}
+
+void URTSCameraReplicator::SetServerState(const FRTSQuantizedCameraState& State)
+{
+	ReplicatedState = State;
+	ViewState = FRTSCameraStateCodec::Dequantize(State);
+}
+
+void URTSCameraReplicator::OnRep_ReplicatedState()
+{
+	const double Now = GetWorld()->GetTimeSeconds();
+
+	/** After an idle period, hold the previous state until just before this one so we don't glide across the whole gap */
+	if (Snapshots.Num() > 0 && Now - Snapshots.Last().Time > 2.0f / MaxSendRate)
+	{
+		FSnapshot Hold = Snapshots.Last();
+		Hold.Time = Now - 1.0f / MaxSendRate;
+		Snapshots.Add(Hold);
+	}
+
+	FSnapshot& Snapshot = Snapshots.AddDefaulted_GetRef();
+	Snapshot.Time = Now;
+	Snapshot.State = FRTSCameraStateCodec::Dequantize(ReplicatedState);
+
+	/** Only a handful of states are ever needed to cover the interpolation delay */
+	constexpr int32 MaxSnapshots = 8;
+	if (Snapshots.Num() > MaxSnapshots)
+	{
+		Snapshots.RemoveAt(0, Snapshots.Num() - MaxSnapshots, EAllowShrinking::No);
+	}
+
+	FBitWriter SizeWriter(0, true);
+	bool bSuccess;
+	ReplicatedState.NetSerialize(SizeWriter, nullptr, bSuccess);
+	CountBytes(SizeWriter.GetNumBytes());
+}
+
+void URTSCameraReplicator::InterpolateRemoteState()
+{
+	if (Snapshots.Num() == 0)
+	{
+		return;
+	}
+
+	const double RenderTime = GetWorld()->GetTimeSeconds() - InterpolationDelay;
+	int32 Next = 0;
+	while (Next < Snapshots.Num() && Snapshots[Next].Time <= RenderTime)
+	{
+		++Next;
+	}
+
+	if (Next == 0 || Next == Snapshots.Num())
+	{
+		ViewState = Snapshots[FMath::Min(Next, Snapshots.Num() - 1)].State;
+	}
+	else
+	{
+		const FSnapshot& From = Snapshots[Next - 1];
+		const FSnapshot& To = Snapshots[Next];
+		const float Alpha = static_cast<float>((RenderTime - From.Time) / FMath::Max(To.Time - From.Time, UE_SMALL_NUMBER));
+		ViewState.Location = FMath::Lerp(From.State.Location, To.State.Location, Alpha);
+		ViewState.Yaw = From.State.Yaw + FRotator::NormalizeAxis(To.State.Yaw - From.State.Yaw) * Alpha;
+		ViewState.Pitch = FMath::Lerp(From.State.Pitch, To.State.Pitch, Alpha);
+		ViewState.Zoom = FMath::Lerp(From.State.Zoom, To.State.Zoom, Alpha);
+	}
+
+	if (bDriveRemoteRig)
+	{
+		ApplyViewStateToRig();
+	}
+}
+
+void URTSCameraReplicator::ApplyViewStateToRig() const
+{
+	const auto RootRotation = Root->GetComponentRotation();
+	Root->SetWorldLocationAndRotation(ViewState.Location, FRotator(RootRotation.Pitch, ViewState.Yaw, RootRotation.Roll));
+
+	const auto ArmRotation = SpringArm->GetRelativeRotation();
+	SpringArm->SetRelativeRotation(FRotator(ViewState.Pitch, ArmRotation.Yaw, ArmRotation.Roll));
+	SpringArm->TargetArmLength = ViewState.Zoom;
+}
+
+void URTSCameraReplicator::CountBytes(const int32 NumBytes)
+{
+	BytesInWindow += NumBytes;
+	INC_DWORD_STAT_BY(STAT_RTSCameraReplicationBytes, NumBytes);
+
+	const double Now = GetWorld()->GetTimeSeconds();
+	if (Now - BytesWindowStart >= 1.0)
+	{
+		BytesPerSecond = static_cast<float>(BytesInWindow / (Now - BytesWindowStart));
+		BytesInWindow = 0;
+		BytesWindowStart = Now;
+	}
+}
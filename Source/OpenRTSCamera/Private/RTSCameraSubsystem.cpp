@@ -0,0 +1,351 @@
+// Copyright 2024 Jesus Bracho All Rights Reserved.
+
+#include "RTSCameraSubsystem.h"
+
+#include "RTSCamera.h"
+#include "RTSCameraStats.h"
+#include "RTSSelectableRegistry.h"
+#include "Engine/Level.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+
+DECLARE_CYCLE_STAT(TEXT("Camera Rigs Update"), STAT_RTSCameraRigsUpdate, STATGROUP_OpenRTSCamera);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Camera Ground Traces"), STAT_RTSCameraGroundTraces, STATGROUP_OpenRTSCamera);
+
+namespace
+{
+	/** Bilinear height between the four cache corners around the location, or at a ground edge (cliffs, holes...) the
+	 * average of whatever corners did hit. SampleCorner returns the FGroundSample of a corner */
+	template <typename FSampleCorner>
+	bool InterpolateGroundHeight(const FVector& Location, const float CellSize, FSampleCorner&& SampleCorner, float& OutHeight)
+	{
+		const double CellX = Location.X / CellSize;
+		const double CellY = Location.Y / CellSize;
+		const FIntPoint Corner(FMath::FloorToInt32(CellX), FMath::FloorToInt32(CellY));
+		const float AlphaX = static_cast<float>(CellX - Corner.X);
+		const float AlphaY = static_cast<float>(CellY - Corner.Y);
+
+		const auto S00 = SampleCorner(Corner);
+		const auto S10 = SampleCorner(Corner + FIntPoint(1, 0));
+		const auto S01 = SampleCorner(Corner + FIntPoint(0, 1));
+		const auto S11 = SampleCorner(Corner + FIntPoint(1, 1));
+
+		if (S00.bHit && S10.bHit && S01.bHit && S11.bHit)
+		{
+			OutHeight = FMath::BiLerp(S00.Height, S10.Height, S01.Height, S11.Height, AlphaX, AlphaY);
+			return true;
+		}
+
+		float Sum = 0;
+		int32 Hits = 0;
+		for (const auto* Sample : {&S00, &S10, &S01, &S11})
+		{
+			if (Sample->bHit)
+			{
+				Sum += Sample->Height;
+				++Hits;
+			}
+		}
+
+		if (Hits > 0)
+		{
+			OutHeight = Sum / Hits;
+			return true;
+		}
+		return false;
+	}
+}
+
+void FRTSCameraSubsystemTickFunction::ExecuteTick(
+	const float DeltaTime,
+	ELevelTick TickType,
+	ENamedThreads::Type CurrentThread,
+	const FGraphEventRef& MyCompletionGraphEvent
+)
+{
+	if (Subsystem)
+	{
+		Subsystem->TickCameras(DeltaTime);
+	}
+}
+
+FString FRTSCameraSubsystemTickFunction::DiagnosticMessage()
+{
+	return TEXT("URTSCameraSubsystem::TickCameras");
+}
+
+void URTSCameraSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	/** Follow targets and ground heights are read after movement, so the rigs no longer lag a frame behind their targets */
+	TickFunction.Subsystem = this;
+	TickFunction.TickGroup = TG_DuringPhysics;
+	TickFunction.bCanEverTick = true;
+	TickFunction.bStartWithTickEnabled = true;
+	TickFunction.RegisterTickFunction(InWorld.PersistentLevel);
+	if (const auto Registry = InWorld.GetSubsystem<URTSSelectableRegistry>())
+	{
+		TickFunction.AddPrerequisite(Registry, Registry->GetSyncTickFunction());
+	}
+}
+
+void URTSCameraSubsystem::Deinitialize()
+{
+	if (TickFunction.IsTickFunctionRegistered())
+	{
+		TickFunction.UnRegisterTickFunction();
+	}
+	TickFunction.Subsystem = nullptr;
+	Super::Deinitialize();
+}
+
+void URTSCameraSubsystem::RegisterCamera(URTSCamera* Camera)
+{
+	Cameras.AddUnique(Camera);
+}
+
+void URTSCameraSubsystem::UnregisterCamera(URTSCamera* Camera)
+{
+	Cameras.Remove(Camera);
+}
+
+FRTSCameraInputSnapshot URTSCameraSubsystem::GetInputSnapshot(const APlayerController* PlayerController) const
+{
+	const auto Snapshot = InputSnapshots.Find(PlayerController);
+	return Snapshot ? *Snapshot : FRTSCameraInputSnapshot();
+}
+
+void URTSCameraSubsystem::TickCameras(const float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_RTSCameraRigsUpdate);
+
+	Cameras.RemoveAllSwap([](const URTSCamera* Camera) { return !IsValid(Camera); }, EAllowShrinking::No);
+	CaptureInputSnapshots();
+	UpdateCursorGroundHits();
+
+	for (const auto Camera : Cameras)
+	{
+		Camera->TickRig(DeltaTime, GetInputSnapshot(Camera->PlayerController));
+	}
+
+	PruneGroundCache();
+}
+
+void URTSCameraSubsystem::CaptureInputSnapshots()
+{
+	InputSnapshots.Reset();
+	for (const auto Camera : Cameras)
+	{
+		CaptureInputSnapshot(Camera->PlayerController);
+	}
+
+	CursorTrackedControllers.RemoveAllSwap([](const APlayerController* PlayerController) { return !IsValid(PlayerController); }, EAllowShrinking::No);
+	for (const auto PlayerController : CursorTrackedControllers)
+	{
+		CaptureInputSnapshot(PlayerController);
+	}
+}
+
+void URTSCameraSubsystem::CaptureInputSnapshot(const APlayerController* PlayerController)
+{
+	if (PlayerController == nullptr || InputSnapshots.Contains(PlayerController))
+	{
+		return;
+	}
+
+	FRTSCameraInputSnapshot& Snapshot = InputSnapshots.Add(PlayerController);
+	int32 ViewportX = 0;
+	int32 ViewportY = 0;
+	PlayerController->GetViewportSize(ViewportX, ViewportY);
+	Snapshot.ViewportSize = FVector2D(ViewportX, ViewportY);
+
+	float MouseX = 0;
+	float MouseY = 0;
+	Snapshot.bHasMouse = PlayerController->GetMousePosition(MouseX, MouseY) && ViewportX > 0 && ViewportY > 0;
+	Snapshot.MousePosition = FVector2D(MouseX, MouseY);
+}
+
+void URTSCameraSubsystem::RequestCursorTracking(APlayerController* PlayerController)
+{
+	CursorTrackedControllers.AddUnique(PlayerController);
+}
+
+FRTSCursorGroundHit URTSCameraSubsystem::GetCursorGroundHit(const APlayerController* PlayerController) const
+{
+	const auto CursorState = CursorStates.Find(PlayerController);
+	return CursorState ? CursorState->Hit : FRTSCursorGroundHit();
+}
+
+void URTSCameraSubsystem::UpdateCursorGroundHits()
+{
+	UWorld* World = GetWorld();
+
+	/** Forget controllers that went away */
+	for (auto It = CursorStates.CreateIterator(); It; ++It)
+	{
+		if (!InputSnapshots.Contains(It.Key()))
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	for (const auto& [PlayerController, Snapshot] : InputSnapshots)
+	{
+		FCursorState& CursorState = CursorStates.FindOrAdd(PlayerController);
+		FRTSCursorGroundHit& Hit = CursorState.Hit;
+
+		/** Pick up last frame's trace, it resolved while the rest of the frame ran */
+		FTraceDatum TraceData;
+		const bool bTraceReady = CursorState.PendingTrace.IsValid() && World->QueryTraceData(CursorState.PendingTrace, TraceData);
+		const FHitResult* TraceHit = bTraceReady ? FHitResult::GetFirstBlockingHit(TraceData.OutHits) : nullptr;
+		CursorState.PendingTrace = FTraceHandle();
+
+		FVector RayOrigin;
+		FVector RayDirection;
+		if (!Snapshot.bHasMouse || !PlayerController->DeprojectScreenPositionToWorld(Snapshot.MousePosition.X, Snapshot.MousePosition.Y, RayOrigin, RayDirection))
+		{
+			Hit = FRTSCursorGroundHit();
+			continue;
+		}
+
+		Hit.RayOrigin = RayOrigin;
+		Hit.RayDirection = RayDirection;
+		if (TraceHit)
+		{
+			Hit.Location = TraceHit->Location;
+			Hit.bFromTrace = true;
+			Hit.bValid = true;
+		}
+		else
+		{
+			/** No trace result (first frame, or the last ray missed). Slide the last hit along the current ray, without
+			 * tracing, the real hit arrives next frame */
+			const float ReferenceZ = Hit.bValid ? Hit.Location.Z : 0.0f;
+			Hit.bFromTrace = false;
+			Hit.bValid = ApproximateCursorGroundHit(RayOrigin, RayDirection, ReferenceZ, Hit.Location);
+		}
+
+		FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(RTSCursorGround), true);
+		for (const auto Camera : Cameras)
+		{
+			QueryParams.AddIgnoredActor(Camera->GetOwner());
+		}
+
+		CursorState.PendingTrace = World->AsyncLineTraceByObjectType(
+			EAsyncTraceType::Single,
+			RayOrigin,
+			RayOrigin + RayDirection * CursorTraceLength,
+			FCollisionObjectQueryParams(ECC_GameTraceChannel2), // Adjust to your "Terrain" channel
+			QueryParams
+		);
+	}
+}
+
+bool URTSCameraSubsystem::ApproximateCursorGroundHit(const FVector& RayOrigin, const FVector& RayDirection, const float ReferenceZ, FVector& OutLocation) const
+{
+	if (RayDirection.Z > -UE_KINDA_SMALL_NUMBER)
+	{
+		return false;
+	}
+
+	/** Reproject onto the height of the last hit, then refine once with whatever the cache already knows there */
+	const auto IntersectAt = [&RayOrigin, &RayDirection, &OutLocation](const float PlaneZ)
+	{
+		const double Distance = (PlaneZ - RayOrigin.Z) / RayDirection.Z;
+		if (Distance < 0)
+		{
+			return false;
+		}
+		OutLocation = RayOrigin + RayDirection * Distance;
+		OutLocation.Z = PlaneZ;
+		return true;
+	};
+
+	if (!IntersectAt(ReferenceZ))
+	{
+		return false;
+	}
+
+	/** Keeps the first intersection when the cache has nothing there, or when the refined height is above the camera */
+	float GroundHeight;
+	if (GetCachedGroundHeight(OutLocation, GroundHeight))
+	{
+		IntersectAt(GroundHeight);
+	}
+	return true;
+}
+
+bool URTSCameraSubsystem::GetGroundHeight(const FVector& Location, const float TraceLength, float& OutHeight)
+{
+	return InterpolateGroundHeight(Location, GroundHeightCellSize, [this, &Location, TraceLength](const FIntPoint& Corner)
+	{
+		return SampleGroundCorner(Corner, Location.Z, TraceLength);
+	}, OutHeight);
+}
+
+bool URTSCameraSubsystem::GetCachedGroundHeight(const FVector& Location, float& OutHeight) const
+{
+	const double Now = GetWorld()->GetTimeSeconds();
+	return InterpolateGroundHeight(Location, GroundHeightCellSize, [this, Now](const FIntPoint& Corner)
+	{
+		/** Corners that are missing or expired count as misses, they are never traced from here */
+		const FGroundSample* Sample = GroundCache.Find(Corner);
+		return Sample && Now - Sample->Time <= GroundHeightCacheLifetime ? *Sample : FGroundSample();
+	}, OutHeight);
+}
+
+URTSCameraSubsystem::FGroundSample URTSCameraSubsystem::SampleGroundCorner(
+	const FIntPoint& Corner,
+	const float StartZ,
+	const float TraceLength
+)
+{
+	const double Now = GetWorld()->GetTimeSeconds();
+	FGroundSample& Sample = GroundCache.FindOrAdd(Corner);
+	if (Sample.Time > 0 && Now - Sample.Time <= GroundHeightCacheLifetime)
+	{
+		return Sample;
+	}
+
+	INC_DWORD_STAT(STAT_RTSCameraGroundTraces);
+
+	/** The camera rigs themselves never count as ground */
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(RTSCameraGround), true);
+	for (const auto Camera : Cameras)
+	{
+		QueryParams.AddIgnoredActor(Camera->GetOwner());
+	}
+
+	const double X = Corner.X * GroundHeightCellSize;
+	const double Y = Corner.Y * GroundHeightCellSize;
+	FHitResult HitResult;
+	Sample.bHit = GetWorld()->LineTraceSingleByObjectType(
+		HitResult,
+		FVector(X, Y, StartZ + TraceLength),
+		FVector(X, Y, StartZ - TraceLength),
+		FCollisionObjectQueryParams(ECC_GameTraceChannel2), // Adjust to your "Terrain" channel
+		QueryParams
+	);
+	Sample.Height = HitResult.Location.Z;
+	Sample.Time = FMath::Max(Now, UE_SMALL_NUMBER);
+	return Sample;
+}
+
+void URTSCameraSubsystem::PruneGroundCache()
+{
+	const double Now = GetWorld()->GetTimeSeconds();
+	if (Now - LastGroundCachePruneTime < GroundHeightCacheLifetime)
+	{
+		return;
+	}
+
+	LastGroundCachePruneTime = Now;
+	for (auto It = GroundCache.CreateIterator(); It; ++It)
+	{
+		if (Now - It.Value().Time > GroundHeightCacheLifetime)
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
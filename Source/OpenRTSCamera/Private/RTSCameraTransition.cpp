@@ -0,0 +1,43 @@
+// Copyright 2024 Jesus Bracho All Rights Reserved.
+
+#include "RTSCameraTransition.h"
+
+void FRTSCameraTransition::Start(
+	const FRTSCameraBookmark& InFrom,
+	const FRTSCameraBookmark& To,
+	const FRTSCameraTransitionSettings& Settings,
+	const float MaxZoom
+)
+{
+	From = InFrom;
+	Delta = To.Location - From.Location;
+	DeltaYaw = FRotator::NormalizeAxis(To.Yaw - From.Yaw);
+	DeltaZoom = To.Zoom - From.Zoom;
+
+	const float Distance = static_cast<float>(Delta.Size2D());
+	Duration = FMath::Clamp(Distance / FMath::Max(Settings.Speed, 1.0f), Settings.MinDuration, FMath::Max(Settings.MinDuration, Settings.MaxDuration));
+	ArcHeight = Distance * Settings.ArcHeightRatio;
+
+	/** The bump is added on top of the straight zoom line, so cap it where that line peaks */
+	ZoomBump = FMath::Max(FMath::Min(Distance * Settings.ZoomOutRatio, MaxZoom - FMath::Max(From.Zoom, To.Zoom)), 0.0f);
+
+	Elapsed = 0;
+	bActive = Duration > 0;
+}
+
+bool FRTSCameraTransition::Advance(const float DeltaTime, FRTSCameraBookmark& OutState)
+{
+	Elapsed += DeltaTime;
+	const float Alpha = bActive ? FMath::Clamp(Elapsed / Duration, 0.0f, 1.0f) : 1.0f;
+
+	/** Smoothstep progress, and a parabola that is 0 at both ends and 1 at the midpoint */
+	const float Progress = Alpha * Alpha * (3.0f - 2.0f * Alpha);
+	const float Bump = 4.0f * Progress * (1.0f - Progress);
+
+	OutState.Location = From.Location + Delta * Progress + FVector(0, 0, ArcHeight * Bump);
+	OutState.Yaw = From.Yaw + DeltaYaw * Progress;
+	OutState.Zoom = From.Zoom + DeltaZoom * Progress + ZoomBump * Bump;
+
+	bActive = Alpha < 1.0f;
+	return bActive;
+}
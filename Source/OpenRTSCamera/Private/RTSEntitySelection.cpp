@@ -0,0 +1,49 @@
+// Copyright 2024 Jesus Bracho All Rights Reserved.
+
+#include "RTSEntitySelection.h"
+
+#include "RTSSelectableRegistry.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/World.h"
+
+URTSInstancedMeshSelectionSource* URTSInstancedMeshSelectionSource::RegisterInstancedMesh(UInstancedStaticMeshComponent* InComponent)
+{
+	const auto World = InComponent ? InComponent->GetWorld() : nullptr;
+	const auto Registry = World ? World->GetSubsystem<URTSSelectableRegistry>() : nullptr;
+	if (Registry == nullptr)
+	{
+		return nullptr;
+	}
+
+	const auto Source = NewObject<URTSInstancedMeshSelectionSource>(Registry);
+	Source->Component = InComponent;
+	Registry->RegisterEntitySource(Source);
+	return Source;
+}
+
+void URTSInstancedMeshSelectionSource::GatherCandidates(FRTSEntityCandidates& OutCandidates) const
+{
+	if (!IsValid(Component))
+	{
+		return;
+	}
+
+	const FBoxSphereBounds MeshBounds = Component->GetStaticMesh() ? Component->GetStaticMesh()->GetBounds() : FBoxSphereBounds(ForceInit);
+	const FTransform& ComponentTransform = Component->GetComponentTransform();
+	const int32 NumInstances = Component->PerInstanceSMData.Num();
+
+	OutCandidates.Locations.Reserve(OutCandidates.Locations.Num() + NumInstances);
+	OutCandidates.BoundsRadii.Reserve(OutCandidates.BoundsRadii.Num() + NumInstances);
+	OutCandidates.Indices.Reserve(OutCandidates.Indices.Num() + NumInstances);
+
+	for (int32 Index = 0; Index < NumInstances; ++Index)
+	{
+		const FTransform InstanceTransform = FTransform(Component->PerInstanceSMData[Index].Transform) * ComponentTransform;
+		OutCandidates.Add(
+			InstanceTransform.TransformPosition(MeshBounds.Origin),
+			MeshBounds.SphereRadius * InstanceTransform.GetMaximumAxisScale(),
+			Index
+		);
+	}
+}
@@ -0,0 +1,114 @@
+// Copyright 2024 Jesus Bracho All Rights Reserved.
+
+#include "RTSFollowGroup.h"
+
+void FRTSFollowGroup::Reset()
+{
+	Locations.Reset();
+	Sum = FVector::ZeroVector;
+	SumOfSquares = 0;
+	Bounds = FBox(ForceInit);
+	bStale = false;
+	NumMovesSinceRefresh = 0;
+}
+
+void FRTSFollowGroup::Add(const void* Key, const FVector& Location)
+{
+	if (Locations.Contains(Key))
+	{
+		Move(Key, Location);
+		return;
+	}
+
+	Locations.Add(Key, Location);
+	Sum += Location;
+	SumOfSquares += Location.SizeSquared();
+	Bounds += Location;
+	bStale = true;
+}
+
+void FRTSFollowGroup::Move(const void* Key, const FVector& Location)
+{
+	FVector* Previous = Locations.Find(Key);
+	if (Previous == nullptr)
+	{
+		return;
+	}
+
+	Sum += Location - *Previous;
+	SumOfSquares += Location.SizeSquared() - Previous->SizeSquared();
+
+	/** Growing the bounds is exact, but a member leaving a face of the box inward may shrink it */
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		if ((Previous->Component(Axis) <= Bounds.Min.Component(Axis) && Location.Component(Axis) > Bounds.Min.Component(Axis))
+			|| (Previous->Component(Axis) >= Bounds.Max.Component(Axis) && Location.Component(Axis) < Bounds.Max.Component(Axis)))
+		{
+			bStale = true;
+		}
+	}
+	Bounds += Location;
+	*Previous = Location;
+
+	if (++NumMovesSinceRefresh >= Num())
+	{
+		bStale = true;
+	}
+}
+
+void FRTSFollowGroup::Remove(const void* Key)
+{
+	FVector Previous;
+	if (Locations.RemoveAndCopyValue(Key, Previous))
+	{
+		Sum -= Previous;
+		SumOfSquares -= Previous.SizeSquared();
+		bStale = true;
+	}
+}
+
+void FRTSFollowGroup::Refresh()
+{
+	if (!bStale)
+	{
+		return;
+	}
+
+	Sum = FVector::ZeroVector;
+	SumOfSquares = 0;
+	Bounds = FBox(ForceInit);
+	for (const auto& Member : Locations)
+	{
+		Sum += Member.Value;
+		SumOfSquares += Member.Value.SizeSquared();
+		Bounds += Member.Value;
+	}
+	bStale = false;
+	NumMovesSinceRefresh = 0;
+}
+
+float FRTSFollowGroup::GetSpreadRadius() const
+{
+	if (Num() == 0)
+	{
+		return 0;
+	}
+
+	/** E[|p|^2] - |E[p]|^2, clamped since rounding can take it slightly below zero */
+	const double MeanOfSquares = SumOfSquares / Num();
+	const double Variance = MeanOfSquares - GetCentroid().SizeSquared();
+	return static_cast<float>(FMath::Sqrt(FMath::Max(Variance, 0.0)));
+}
+
+float FRTSFollowGroup::GetExtentRadius() const
+{
+	if (Num() == 0 || !Bounds.IsValid)
+	{
+		return 0;
+	}
+
+	const FVector Centroid = GetCentroid();
+	const double X = FMath::Max(Centroid.X - Bounds.Min.X, Bounds.Max.X - Centroid.X);
+	const double Y = FMath::Max(Centroid.Y - Bounds.Min.Y, Bounds.Max.Y - Centroid.Y);
+	return static_cast<float>(FMath::Sqrt(FMath::Square(FMath::Max(X, 0.0)) + FMath::Square(FMath::Max(Y, 0.0))));
+}
@@ -1,12 +1,83 @@
 #include "RTSHUD.h"
+#include "RTSCameraStats.h"
 #include "RTSSelector.h"
+#include "RenderUtils.h"
 #include "Engine/Canvas.h"
 
+DECLARE_CYCLE_STAT(TEXT("Selection Box Draw"), STAT_RTSSelectionBoxDraw, STATGROUP_OpenRTSCamera);
+
+namespace
+{
+	// Appends an axis aligned rectangle as two triangles
+	void AddRectangle(TArray<FCanvasUVTri>& Triangles, const FVector2D& Min, const FVector2D& Max, const FLinearColor& Color)
+	{
+		if (Min.X >= Max.X || Min.Y >= Max.Y)
+		{
+			return;
+		}
+
+		FCanvasUVTri& First = Triangles.AddDefaulted_GetRef();
+		First.V0_Pos = Min;
+		First.V1_Pos = FVector2D(Max.X, Min.Y);
+		First.V2_Pos = Max;
+		First.V0_Color = First.V1_Color = First.V2_Color = Color;
+
+		FCanvasUVTri& Second = Triangles.AddDefaulted_GetRef();
+		Second.V0_Pos = Min;
+		Second.V1_Pos = Max;
+		Second.V2_Pos = FVector2D(Min.X, Max.Y);
+		Second.V0_Color = Second.V1_Color = Second.V2_Color = Color;
+	}
+
+	// Appends the outline of a rectangle as four bands that do not overlap, so translucent colors stay even at the corners
+	void AddOutline(TArray<FCanvasUVTri>& Triangles, const FVector2D& Min, const FVector2D& Max, const float Thickness, const FLinearColor& Color)
+	{
+		const FVector2D HalfThickness(Thickness * 0.5f);
+		const FVector2D OuterMin = Min - HalfThickness;
+		const FVector2D OuterMax = Max + HalfThickness;
+		const FVector2D InnerMin = Min + HalfThickness;
+		const FVector2D InnerMax = Max - HalfThickness;
+
+		AddRectangle(Triangles, OuterMin, FVector2D(OuterMax.X, InnerMin.Y), Color);
+		AddRectangle(Triangles, FVector2D(OuterMin.X, InnerMax.Y), OuterMax, Color);
+		AddRectangle(Triangles, FVector2D(OuterMin.X, InnerMin.Y), FVector2D(InnerMin.X, InnerMax.Y), Color);
+		AddRectangle(Triangles, FVector2D(InnerMax.X, InnerMin.Y), FVector2D(OuterMax.X, InnerMax.Y), Color);
+	}
+
+	// Appends an L shaped bracket on each corner of the rectangle
+	void AddBrackets(TArray<FCanvasUVTri>& Triangles, const FBox2D& Bounds, const float LengthRatio, const float Thickness, const FLinearColor& Color)
+	{
+		const FVector2D Size = Bounds.GetSize();
+		const float Length = FMath::Max(FMath::Min(Size.X, Size.Y) * LengthRatio, Thickness);
+		for (int32 Corner = 0; Corner < 4; ++Corner)
+		{
+			const bool bRight = (Corner & 1) != 0;
+			const bool bBottom = (Corner & 2) != 0;
+			const FVector2D Point(bRight ? Bounds.Max.X : Bounds.Min.X, bBottom ? Bounds.Max.Y : Bounds.Min.Y);
+			const FVector2D Inward(bRight ? -1 : 1, bBottom ? -1 : 1);
+
+			// Horizontal arm including the corner, then the vertical arm without it
+			const FVector2D HorizontalEnd = Point + FVector2D(Inward.X * Length, Inward.Y * Thickness);
+			AddRectangle(Triangles, FVector2D::Min(Point, HorizontalEnd), FVector2D::Max(Point, HorizontalEnd), Color);
+
+			const FVector2D VerticalStart = Point + FVector2D(0, Inward.Y * Thickness);
+			const FVector2D VerticalEnd = Point + FVector2D(Inward.X * Thickness, Inward.Y * Length);
+			AddRectangle(Triangles, FVector2D::Min(VerticalStart, VerticalEnd), FVector2D::Max(VerticalStart, VerticalEnd), Color);
+		}
+	}
+}
+
 // Constructor implementation: Initializes default values.
 ARTSHUD::ARTSHUD()
 {
 	SelectionBoxColor = FLinearColor::White;
 	SelectionBoxThickness = 1.5f;
+	bFillSelectionBox = false;
+	SelectionBoxFillColor = FLinearColor(1.0f, 1.0f, 1.0f, 0.1f);
+	bHighlightUnitsInSelectionBox = false;
+	HighlightBracketColor = FLinearColor::Green;
+	HighlightBracketLength = 0.25f;
+	HighlightQueryInterval = 0.1f;
 	bIsDrawingSelectionBox = false;
 	bIsPerformingSelection = false;
 }
@@ -34,6 +105,7 @@ void ARTSHUD::BeginSelection(const FVector2D& StartPoint)
 {
 	SelectionStart = StartPoint;
 	bIsDrawingSelectionBox = true;
+	LastHighlightQuerySeconds = TNumericLimits<double>::Lowest();
 }
 
 // Updates the current endpoint of the selection box.
@@ -49,36 +121,148 @@ void ARTSHUD::EndSelection()
 	bIsPerformingSelection = true;
 }
 
-// Default implementation of DrawSelectionBox. Draws a rectangle on the HUD.
+// Stops the selection process without selecting anything.
+void ARTSHUD::CancelSelection()
+{
+	bIsDrawingSelectionBox = false;
+	bIsPerformingSelection = false;
+}
+
+// Default implementation of DrawSelectionBox. Draws the rectangle, its fill and the pre-selection brackets as one canvas batch.
 void ARTSHUD::DrawSelectionBox_Implementation(const FVector2D& StartPoint, const FVector2D& EndPoint)
 {
-	if (Canvas)
+	SCOPE_CYCLE_COUNTER(STAT_RTSSelectionBoxDraw);
+
+	if (Canvas == nullptr)
+	{
+		return;
+	}
+
+	const FBox2D Box(FVector2D::Min(StartPoint, EndPoint), FVector2D::Max(StartPoint, EndPoint));
+	const uint32 StyleHash = GetSelectionBoxStyleHash();
+	const bool bStyleChanged = StyleHash != BuiltStyleHash;
+	BuiltStyleHash = StyleHash;
+
+	// The outline follows the cursor every frame, it is a handful of triangles
+	if (SelectionBoxItem == nullptr || Box != BuiltSelectionBox || bStyleChanged)
 	{
-		// Calculate corners of the selection rectangle.
-		const auto TopRight = FVector2D(SelectionEnd.X, SelectionStart.Y);
-		const auto BottomLeft = FVector2D(SelectionStart.X, SelectionEnd.Y);
+		BuildSelectionBoxTriangles(Box);
+		BuiltSelectionBox = Box;
+	}
 
-		// Draw lines to form the selection rectangle.
-		Canvas->K2_DrawLine(SelectionStart, TopRight, SelectionBoxThickness, SelectionBoxColor);
-		Canvas->K2_DrawLine(TopRight, SelectionEnd, SelectionBoxThickness, SelectionBoxColor);
-		Canvas->K2_DrawLine(SelectionEnd, BottomLeft, SelectionBoxThickness, SelectionBoxColor);
-		Canvas->K2_DrawLine(BottomLeft, SelectionStart, SelectionBoxThickness, SelectionBoxColor);
+	// Classifying and projecting the units is the expensive part, it runs at a fixed rate and the brackets are only
+	// rebuilt when it found something else
+	const bool bQueried = QueryHighlightBounds(Box);
+	if (HighlightItem == nullptr || bStyleChanged || (bQueried && HighlightBounds != BuiltHighlightBounds))
+	{
+		BuildHighlightTriangles();
+	}
+
+	Canvas->DrawItem(*SelectionBoxItem);
+	if (HighlightItem->TriangleList.Num() > 0)
+	{
+		Canvas->DrawItem(*HighlightItem);
 	}
 }
 
+bool ARTSHUD::QueryHighlightBounds(const FBox2D& Box)
+{
+	const double Now = GetWorld() ? GetWorld()->GetRealTimeSeconds() : 0;
+	if (Now - LastHighlightQuerySeconds < HighlightQueryInterval)
+	{
+		return false;
+	}
+	LastHighlightQuerySeconds = Now;
+
+	HighlightBounds.Reset();
+	if (bHighlightUnitsInSelectionBox)
+	{
+		if (const auto PC = GetOwningPlayerController())
+		{
+			// Only when release goes through the registry too, the clusters and the actor query select other sets
+			const auto SelectorComponent = PC->FindComponentByClass<URTSSelector>();
+			if (SelectorComponent && !SelectorComponent->IsClusteringActive() && SelectorComponent->CanBoxSelectFromRegistry())
+			{
+				SelectorComponent->GetSelectableScreenBoundsInRectangle(Box.Min, Box.Max, HighlightBounds);
+			}
+		}
+	}
+	return true;
+}
+
+uint32 ARTSHUD::GetSelectionBoxStyleHash() const
+{
+	uint32 Hash = GetTypeHash(SelectionBoxColor);
+	Hash = HashCombineFast(Hash, GetTypeHash(SelectionBoxThickness));
+	Hash = HashCombineFast(Hash, GetTypeHash(bFillSelectionBox));
+	Hash = HashCombineFast(Hash, GetTypeHash(SelectionBoxFillColor));
+	Hash = HashCombineFast(Hash, GetTypeHash(HighlightBracketColor));
+	return HashCombineFast(Hash, GetTypeHash(HighlightBracketLength));
+}
+
+void ARTSHUD::BuildSelectionBoxTriangles(const FBox2D& Box)
+{
+	if (SelectionBoxItem == nullptr)
+	{
+		SelectionBoxItem = MakeUnique<FCanvasTriangleItem>(TArray<FCanvasUVTri>(), GWhiteTexture);
+		SelectionBoxItem->BlendMode = SE_BLEND_Translucent;
+	}
+
+	TArray<FCanvasUVTri>& Triangles = SelectionBoxItem->TriangleList;
+	Triangles.Reset();
+
+	if (bFillSelectionBox)
+	{
+		const FVector2D HalfThickness(SelectionBoxThickness * 0.5f);
+		AddRectangle(Triangles, Box.Min + HalfThickness, Box.Max - HalfThickness, SelectionBoxFillColor);
+	}
+	AddOutline(Triangles, Box.Min, Box.Max, SelectionBoxThickness, SelectionBoxColor);
+}
+
+void ARTSHUD::BuildHighlightTriangles()
+{
+	if (HighlightItem == nullptr)
+	{
+		HighlightItem = MakeUnique<FCanvasTriangleItem>(TArray<FCanvasUVTri>(), GWhiteTexture);
+		HighlightItem->BlendMode = SE_BLEND_Translucent;
+	}
+
+	// Reset keeps the allocation, the list only grows when more units are under the box than ever before
+	TArray<FCanvasUVTri>& Triangles = HighlightItem->TriangleList;
+	Triangles.Reset();
+	for (const FBox2D& Bounds : HighlightBounds)
+	{
+		AddBrackets(Triangles, Bounds, HighlightBracketLength, SelectionBoxThickness, HighlightBracketColor);
+	}
+	BuiltHighlightBounds = HighlightBounds;
+}
+
 // Default implementation of PerformSelection. Selects actors within the selection box.
 void ARTSHUD::PerformSelection_Implementation()
 {
-	// Array to store actors that are within the selection rectangle.
-	TArray<AActor*> SelectedActors;
-	GetActorsInSelectionRectangle<AActor>(SelectionStart, SelectionEnd, SelectedActors, false, false);
-
 	// Find the URTSSelector component and pass the selected actors to it.
 	if (const auto PC = GetOwningPlayerController())
 	{
 		if (const auto SelectorComponent = PC->FindComponentByClass<URTSSelector>())
 		{
-			SelectorComponent->HandleSelectedActors(SelectedActors);
+			// Zoomed far out the box works on screen clusters, individual units are too small to pick apart
+			if (SelectorComponent->IsClusteringActive())
+			{
+				SelectorComponent->SelectClustersInRectangle(SelectionStart, SelectionEnd);
+			}
+			else if (SelectorComponent->CanBoxSelectFromRegistry())
+			{
+				// Registered units are tested against the planes of the box instead of projecting every actor's bounds
+				SelectorComponent->SelectSelectablesInRectangle(SelectionStart, SelectionEnd);
+			}
+			else
+			{
+				// Array to store actors that are within the selection rectangle.
+				TArray<AActor*> SelectedActors;
+				GetActorsInSelectionRectangle<AActor>(SelectionStart, SelectionEnd, SelectedActors, false, false);
+				SelectorComponent->HandleSelectedActors(SelectedActors);
+			}
+			SelectorComponent->SelectEntitiesInRectangle(SelectionStart, SelectionEnd);
 		}
 	}
 
@@ -0,0 +1,499 @@
+// Copyright 2024 Jesus Bracho All Rights Reserved.
+
+#include "RTSMinimap.h"
+
+#include "RTSCamera.h"
+#include "RTSCameraStats.h"
+#include "RTSCameraSubsystem.h"
+#include "RTSScreenProjector.h"
+#include "RTSSelectableRegistry.h"
+#include "Async/ParallelFor.h"
+#include "Engine/Texture2D.h"
+#include "Engine/World.h"
+#include "GameFramework/CameraBlockingVolume.h"
+#include "Kismet/GameplayStatics.h"
+
+DECLARE_CYCLE_STAT(TEXT("Minimap Update"), STAT_RTSMinimapUpdate, STATGROUP_OpenRTSCamera);
+DECLARE_CYCLE_STAT(TEXT("Minimap Rasterize"), STAT_RTSMinimapRasterize, STATGROUP_OpenRTSCamera);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Minimap Tiles Redrawn"), STAT_RTSMinimapTilesRedrawn, STATGROUP_OpenRTSCamera);
+
+namespace
+{
+	// Liang-Barsky, clips the segment to the rectangle (exclusive max)
+	bool ClipSegment(FVector2D& A, FVector2D& B, const FIntRect& Rect)
+	{
+		const FVector2D Delta = B - A;
+		double Enter = 0;
+		double Exit = 1;
+		const double P[4] = {-Delta.X, Delta.X, -Delta.Y, Delta.Y};
+		const double Q[4] = {A.X - Rect.Min.X, Rect.Max.X - A.X, A.Y - Rect.Min.Y, Rect.Max.Y - A.Y};
+		for (int32 Edge = 0; Edge < 4; ++Edge)
+		{
+			if (FMath::IsNearlyZero(P[Edge]))
+			{
+				if (Q[Edge] < 0)
+				{
+					return false;
+				}
+				continue;
+			}
+
+			const double T = Q[Edge] / P[Edge];
+			if (P[Edge] < 0)
+			{
+				Enter = FMath::Max(Enter, T);
+			}
+			else
+			{
+				Exit = FMath::Min(Exit, T);
+			}
+		}
+
+		if (Enter > Exit)
+		{
+			return false;
+		}
+
+		const FVector2D Start = A;
+		A = Start + Delta * Enter;
+		B = Start + Delta * Exit;
+		return true;
+	}
+}
+
+void FRTSMinimapRaster::Initialize(const FBox2D& InBounds, const float BoundsMargin, const int32 InSize, const int32 InTileSize, const FStyle& InStyle)
+{
+	Style = InStyle;
+	Style.UnitSize = FMath::Max(Style.UnitSize, 1);
+	if (Style.TeamColors.Num() == 0)
+	{
+		Style.TeamColors.Add(FColor::White);
+	}
+
+	Size = FMath::Max(InSize, 1);
+	TileSize = FMath::Clamp(InTileSize, 1, Size);
+	NumTilesPerSide = FMath::DivideAndRoundUp(Size, TileSize);
+
+	// Square around the bounds so pixels stay square whatever the shape of the level
+	const double HalfExtent = FMath::Max(InBounds.GetExtent().GetMax() * (1.0 + BoundsMargin), 1.0);
+	Origin = InBounds.GetCenter() - FVector2D(HalfExtent);
+	PixelsPerUnit = Size / (2.0 * HalfExtent);
+
+	const FVector2D BoundsTopLeft = WorldToPixel(FVector(InBounds.Max.X, InBounds.Min.Y, 0));
+	const FVector2D BoundsBottomRight = WorldToPixel(FVector(InBounds.Min.X, InBounds.Max.Y, 0));
+	const FIntRect BoundsRect(
+		FMath::FloorToInt(BoundsTopLeft.X), FMath::FloorToInt(BoundsTopLeft.Y),
+		FMath::FloorToInt(BoundsBottomRight.X), FMath::FloorToInt(BoundsBottomRight.Y)
+	);
+
+	Background.SetNumUninitialized(Size * Size);
+	for (int32 Y = 0; Y < Size; ++Y)
+	{
+		for (int32 X = 0; X < Size; ++X)
+		{
+			const bool bInside = X >= BoundsRect.Min.X && X <= BoundsRect.Max.X && Y >= BoundsRect.Min.Y && Y <= BoundsRect.Max.Y;
+			const bool bOutline = bInside && (X == BoundsRect.Min.X || X == BoundsRect.Max.X || Y == BoundsRect.Min.Y || Y == BoundsRect.Max.Y);
+			Background[Y * Size + X] = bOutline ? Style.BoundsOutlineColor : bInside ? Style.InsideBoundsColor : Style.OutsideBoundsColor;
+		}
+	}
+
+	Pixels = Background;
+	TileHashes.Init(0, NumTilesPerSide * NumTilesPerSide);
+	bAllTilesDirty = true;
+}
+
+FVector2D FRTSMinimapRaster::WorldToPixel(const FVector& Location) const
+{
+	return FVector2D((Location.Y - Origin.Y) * PixelsPerUnit, Size - (Location.X - Origin.X) * PixelsPerUnit);
+}
+
+FVector2D FRTSMinimapRaster::PixelToWorld(const FVector2D& Pixel) const
+{
+	return FVector2D(Origin.X + (Size - Pixel.Y) / PixelsPerUnit, Origin.Y + Pixel.X / PixelsPerUnit);
+}
+
+FIntRect FRTSMinimapRaster::GetTileRect(const int32 Tile) const
+{
+	const FIntPoint Min((Tile % NumTilesPerSide) * TileSize, (Tile / NumTilesPerSide) * TileSize);
+	return FIntRect(Min, FIntPoint(FMath::Min(Min.X + TileSize, Size), FMath::Min(Min.Y + TileSize, Size)));
+}
+
+int32 FRTSMinimapRaster::Rasterize(const TConstArrayView<FVector> Locations, const TConstArrayView<uint8> Teams, const FRTSMinimapOverlay& Overlay)
+{
+	SCOPE_CYCLE_COUNTER(STAT_RTSMinimapRasterize);
+	check(Locations.Num() == Teams.Num());
+
+	RedrawnTiles.Reset();
+	if (!IsInitialized())
+	{
+		return 0;
+	}
+
+	// Squares of the units, clipped to the minimap
+	const int32 HalfUnit = Style.UnitSize / 2;
+	UnitPixels.Reset();
+	for (int32 Unit = 0; Unit < Locations.Num(); ++Unit)
+	{
+		const FVector2D Pixel = WorldToPixel(Locations[Unit]);
+		const int32 X = FMath::FloorToInt(Pixel.X) - HalfUnit;
+		const int32 Y = FMath::FloorToInt(Pixel.Y) - HalfUnit;
+		if (X + Style.UnitSize > 0 && X < Size && Y + Style.UnitSize > 0 && Y < Size)
+		{
+			UnitPixels.Add({X, Y, Teams[Unit]});
+		}
+	}
+
+	// Counting sort of the units per tile they touch, a square touches at most four tiles
+	const int32 NumTiles = NumTilesPerSide * NumTilesPerSide;
+	const auto ForEachTileOfUnit = [this](const FUnitPixel& Unit, auto&& Function)
+	{
+		const int32 MinTileX = FMath::Max(Unit.X, 0) / TileSize;
+		const int32 MaxTileX = FMath::Min(Unit.X + Style.UnitSize - 1, Size - 1) / TileSize;
+		const int32 MinTileY = FMath::Max(Unit.Y, 0) / TileSize;
+		const int32 MaxTileY = FMath::Min(Unit.Y + Style.UnitSize - 1, Size - 1) / TileSize;
+		for (int32 TileY = MinTileY; TileY <= MaxTileY; ++TileY)
+		{
+			for (int32 TileX = MinTileX; TileX <= MaxTileX; ++TileX)
+			{
+				Function(TileY * NumTilesPerSide + TileX);
+			}
+		}
+	};
+
+	TileStarts.Init(0, NumTiles + 1);
+	for (const FUnitPixel& Unit : UnitPixels)
+	{
+		ForEachTileOfUnit(Unit, [this](const int32 Tile) { ++TileStarts[Tile + 1]; });
+	}
+	for (int32 Tile = 0; Tile < NumTiles; ++Tile)
+	{
+		TileStarts[Tile + 1] += TileStarts[Tile];
+	}
+
+	TileCursors = TileStarts;
+	TileUnits.SetNumUninitialized(TileStarts[NumTiles]);
+	NewTileHashes.Init(0, NumTiles);
+	for (const FUnitPixel& Unit : UnitPixels)
+	{
+		ForEachTileOfUnit(Unit, [this, &Unit](const int32 Tile)
+		{
+			TileUnits[TileCursors[Tile]++] = Unit;
+			NewTileHashes[Tile] = HashCombineFast(NewTileHashes[Tile], HashCombineFast(GetTypeHash(Unit.Y * Size + Unit.X), Unit.Team));
+		});
+	}
+
+	// Footprints are hashed into every tile their bounding box touches, a few extra redraws around the footprint are fine
+	for (const TStaticArray<FVector2D, 4>& Footprint : Overlay.CameraFootprints)
+	{
+		FBox2D FootprintBounds(ForceInit);
+		uint32 FootprintHash = 0;
+		for (const FVector2D& Corner : Footprint)
+		{
+			FootprintBounds += Corner;
+			FootprintHash = HashCombineFast(FootprintHash, HashCombineFast(GetTypeHash(FMath::FloorToInt(Corner.X)), GetTypeHash(FMath::FloorToInt(Corner.Y))));
+		}
+
+		const int32 MinTileX = FMath::Clamp(FMath::FloorToInt(FootprintBounds.Min.X) / TileSize, 0, NumTilesPerSide - 1);
+		const int32 MaxTileX = FMath::Clamp(FMath::FloorToInt(FootprintBounds.Max.X) / TileSize, 0, NumTilesPerSide - 1);
+		const int32 MinTileY = FMath::Clamp(FMath::FloorToInt(FootprintBounds.Min.Y) / TileSize, 0, NumTilesPerSide - 1);
+		const int32 MaxTileY = FMath::Clamp(FMath::FloorToInt(FootprintBounds.Max.Y) / TileSize, 0, NumTilesPerSide - 1);
+		for (int32 TileY = MinTileY; TileY <= MaxTileY; ++TileY)
+		{
+			for (int32 TileX = MinTileX; TileX <= MaxTileX; ++TileX)
+			{
+				uint32& Hash = NewTileHashes[TileY * NumTilesPerSide + TileX];
+				Hash = HashCombineFast(Hash, FootprintHash);
+			}
+		}
+	}
+
+	DirtyTiles.Reset();
+	for (int32 Tile = 0; Tile < NumTiles; ++Tile)
+	{
+		if (bAllTilesDirty || NewTileHashes[Tile] != TileHashes[Tile])
+		{
+			DirtyTiles.Add(Tile);
+		}
+	}
+	Swap(TileHashes, NewTileHashes);
+	bAllTilesDirty = false;
+
+	// Tiles own disjoint pixels, they can be drawn in any order on any thread
+	ParallelFor(DirtyTiles.Num(), [this, &Overlay](const int32 Index)
+	{
+		DrawTile(DirtyTiles[Index], Overlay);
+	});
+
+	for (const int32 Tile : DirtyTiles)
+	{
+		RedrawnTiles.Add(GetTileRect(Tile));
+	}
+	return DirtyTiles.Num();
+}
+
+void FRTSMinimapRaster::DrawTile(const int32 Tile, const FRTSMinimapOverlay& Overlay)
+{
+	const FIntRect Rect = GetTileRect(Tile);
+	for (int32 Y = Rect.Min.Y; Y < Rect.Max.Y; ++Y)
+	{
+		FMemory::Memcpy(&Pixels[Y * Size + Rect.Min.X], &Background[Y * Size + Rect.Min.X], Rect.Width() * sizeof(FColor));
+	}
+
+	for (int32 Index = TileStarts[Tile]; Index < TileStarts[Tile + 1]; ++Index)
+	{
+		const FUnitPixel& Unit = TileUnits[Index];
+		const FColor Color = Style.TeamColors[FMath::Min<int32>(Unit.Team, Style.TeamColors.Num() - 1)];
+		const int32 MinX = FMath::Max(Unit.X, Rect.Min.X);
+		const int32 MaxX = FMath::Min(Unit.X + Style.UnitSize, Rect.Max.X);
+		const int32 MinY = FMath::Max(Unit.Y, Rect.Min.Y);
+		const int32 MaxY = FMath::Min(Unit.Y + Style.UnitSize, Rect.Max.Y);
+		for (int32 Y = MinY; Y < MaxY; ++Y)
+		{
+			for (int32 X = MinX; X < MaxX; ++X)
+			{
+				Pixels[Y * Size + X] = Color;
+			}
+		}
+	}
+
+	// Only the part of each edge that crosses the tile is walked
+	for (const TStaticArray<FVector2D, 4>& Footprint : Overlay.CameraFootprints)
+	{
+		for (int32 Corner = 0; Corner < 4; ++Corner)
+		{
+			FVector2D A = Footprint[Corner];
+			FVector2D B = Footprint[(Corner + 1) % 4];
+			if (!ClipSegment(A, B, Rect))
+			{
+				continue;
+			}
+
+			const int32 NumSteps = FMath::Max(1, FMath::CeilToInt(FMath::Max(FMath::Abs(B.X - A.X), FMath::Abs(B.Y - A.Y))));
+			for (int32 Step = 0; Step <= NumSteps; ++Step)
+			{
+				const FVector2D Point = FMath::Lerp(A, B, static_cast<double>(Step) / NumSteps);
+				const int32 X = FMath::FloorToInt(Point.X);
+				const int32 Y = FMath::FloorToInt(Point.Y);
+				if (X >= Rect.Min.X && X < Rect.Max.X && Y >= Rect.Min.Y && Y < Rect.Max.Y)
+				{
+					Pixels[Y * Size + X] = Style.FootprintColor;
+				}
+			}
+		}
+	}
+}
+
+void URTSMinimapSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+	Registry = InWorld.GetSubsystem<URTSSelectableRegistry>();
+	CameraSubsystem = InWorld.GetSubsystem<URTSCameraSubsystem>();
+}
+
+void URTSMinimapSubsystem::Tick(const float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (!bMinimapEnabled)
+	{
+		return;
+	}
+
+	TimeSinceUpdate += DeltaTime;
+	if (TimeSinceUpdate >= UpdateInterval)
+	{
+		TimeSinceUpdate = 0;
+		UpdateMinimap();
+	}
+}
+
+TStatId URTSMinimapSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(URTSMinimapSubsystem, STATGROUP_OpenRTSCamera);
+}
+
+void URTSMinimapSubsystem::SetMinimapEnabled(const bool bEnabled)
+{
+	bMinimapEnabled = bEnabled;
+	TimeSinceUpdate = UpdateInterval;
+}
+
+void URTSMinimapSubsystem::SetTeamResolver(TFunction<uint8(const AActor*)> InTeamResolver)
+{
+	TeamResolver = MoveTemp(InTeamResolver);
+}
+
+void URTSMinimapSubsystem::UpdateMinimap()
+{
+	SCOPE_CYCLE_COUNTER(STAT_RTSMinimapUpdate);
+
+	if (!EnsureInitialized())
+	{
+		return;
+	}
+
+	TConstArrayView<FVector> Locations;
+	Teams.Reset();
+	if (Registry)
+	{
+		Registry->SyncTransforms();
+		Locations = Registry->GetLocations();
+		for (const AActor* Actor : Registry->GetActors())
+		{
+			Teams.Add(TeamResolver ? TeamResolver(Actor) : 0);
+		}
+	}
+
+	GatherCameraFootprints();
+
+	const int32 NumRedrawn = Raster.Rasterize(Locations, Teams, Overlay);
+	INC_DWORD_STAT_BY(STAT_RTSMinimapTilesRedrawn, NumRedrawn);
+	if (NumRedrawn > 0)
+	{
+		UploadRedrawnTiles();
+	}
+}
+
+FVector URTSMinimapSubsystem::MinimapToWorld(const FVector2D& MinimapPosition) const
+{
+	const FVector2D World = Raster.PixelToWorld(MinimapPosition * Raster.GetSize());
+	return FVector(World.X, World.Y, 0);
+}
+
+FVector2D URTSMinimapSubsystem::WorldToMinimap(const FVector& Location) const
+{
+	return Raster.IsInitialized() ? Raster.WorldToPixel(Location) / Raster.GetSize() : FVector2D::ZeroVector;
+}
+
+bool URTSMinimapSubsystem::JumpToMinimapPosition(URTSCamera* Camera, const FVector2D& MinimapPosition) const
+{
+	if (Camera == nullptr || !Raster.IsInitialized()
+		|| MinimapPosition.X < 0 || MinimapPosition.X > 1 || MinimapPosition.Y < 0 || MinimapPosition.Y > 1)
+	{
+		return false;
+	}
+
+	// JumpTo clamps to the camera bounds and finds the ground height of the destination
+	FVector Destination = MinimapToWorld(MinimapPosition);
+	Destination.Z = Camera->GetOwner()->GetActorLocation().Z;
+	Camera->JumpTo(Destination);
+	return true;
+}
+
+bool URTSMinimapSubsystem::EnsureInitialized()
+{
+	if (Raster.IsInitialized())
+	{
+		return true;
+	}
+
+	// Same volume the camera rigs clamp to, or the area of the units if the level has none
+	FBox2D Bounds(ForceInit);
+	TArray<AActor*> BlockingVolumes;
+	UGameplayStatics::GetAllActorsOfClass(GetWorld(), ACameraBlockingVolume::StaticClass(), BlockingVolumes);
+	if (BlockingVolumes.Num() > 0)
+	{
+		FVector Origin;
+		FVector Extents;
+		BlockingVolumes[0]->GetActorBounds(false, Origin, Extents);
+		Bounds = FBox2D(FVector2D(Origin - Extents), FVector2D(Origin + Extents));
+	}
+	else if (Registry)
+	{
+		for (const FVector& Location : Registry->GetLocations())
+		{
+			Bounds += FVector2D(Location);
+		}
+	}
+
+	if (!Bounds.bIsValid)
+	{
+		return false;
+	}
+
+	FRTSMinimapRaster::FStyle Style;
+	Style.UnitSize = UnitPixelSize;
+	if (TeamColors.Num() > 0)
+	{
+		Style.TeamColors = TeamColors;
+	}
+	Raster.Initialize(Bounds, BoundsMargin, Resolution, TileSize, Style);
+
+	Texture = UTexture2D::CreateTransient(Raster.GetSize(), Raster.GetSize(), PF_B8G8R8A8);
+	if (Texture)
+	{
+		Texture->Filter = TF_Nearest;
+		Texture->UpdateResource();
+	}
+	return true;
+}
+
+void URTSMinimapSubsystem::GatherCameraFootprints()
+{
+	Overlay.CameraFootprints.Reset();
+	if (CameraSubsystem == nullptr)
+	{
+		return;
+	}
+
+	for (const URTSCamera* Camera : CameraSubsystem->GetCameras())
+	{
+		FRTSScreenProjector Projector;
+		if (!IsValid(Camera) || Camera->GetOwner() == nullptr || !Projector.Initialize(Camera->GetPlayerController()))
+		{
+			continue;
+		}
+
+		// Corners of the view on the ground plane of the rig
+		FVector Ground[4];
+		Projector.DeprojectViewToHeight(Camera->GetOwner()->GetActorLocation().Z, MaxFootprintDistance, Ground);
+
+		TStaticArray<FVector2D, 4>& Footprint = Overlay.CameraFootprints.AddDefaulted_GetRef();
+		for (int32 Corner = 0; Corner < 4; ++Corner)
+		{
+			Footprint[Corner] = Raster.WorldToPixel(Ground[Corner]);
+		}
+	}
+}
+
+void URTSMinimapSubsystem::UploadRedrawnTiles()
+{
+	if (Texture == nullptr)
+	{
+		return;
+	}
+
+	// Only the redrawn tiles go to the render thread, stacked in a strip as wide as the widest one so every region
+	// shares the pitch UpdateTextureRegions takes. The render thread reads them later and frees the copy itself
+	const TArray<FIntRect>& Tiles = Raster.GetRedrawnTiles();
+	int32 StripWidth = 0;
+	int32 StripHeight = 0;
+	for (const FIntRect& Tile : Tiles)
+	{
+		StripWidth = FMath::Max(StripWidth, Tile.Width());
+		StripHeight += Tile.Height();
+	}
+
+	const int32 RasterSize = Raster.GetSize();
+	const FColor* Pixels = Raster.GetPixels().GetData();
+	FColor* Strip = static_cast<FColor*>(FMemory::Malloc(StripWidth * StripHeight * sizeof(FColor)));
+	FUpdateTextureRegion2D* Regions = new FUpdateTextureRegion2D[Tiles.Num()];
+	int32 StripY = 0;
+	for (int32 Index = 0; Index < Tiles.Num(); ++Index)
+	{
+		const FIntRect& Tile = Tiles[Index];
+		for (int32 Row = 0; Row < Tile.Height(); ++Row)
+		{
+			FMemory::Memcpy(Strip + (StripY + Row) * StripWidth, Pixels + (Tile.Min.Y + Row) * RasterSize + Tile.Min.X, Tile.Width() * sizeof(FColor));
+		}
+		Regions[Index] = FUpdateTextureRegion2D(Tile.Min.X, Tile.Min.Y, 0, StripY, Tile.Width(), Tile.Height());
+		StripY += Tile.Height();
+	}
+
+	Texture->UpdateTextureRegions(0, Tiles.Num(), Regions, StripWidth * sizeof(FColor), sizeof(FColor), reinterpret_cast<uint8*>(Strip),
+		[](uint8* SrcData, const FUpdateTextureRegion2D* InRegions)
+		{
+			FMemory::Free(SrcData);
+			delete[] InRegions;
+		});
+}
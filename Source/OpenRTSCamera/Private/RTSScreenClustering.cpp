@@ -0,0 +1,76 @@
+// Copyright 2024 Jesus Bracho All Rights Reserved.
+
+#include "RTSScreenClustering.h"
+
+#include "RTSCameraStats.h"
+#include "RTSScreenProjector.h"
+#include "RTSVisibilityGrid.h"
+
+DECLARE_CYCLE_STAT(TEXT("Screen Clustering"), STAT_RTSScreenClustering, STATGROUP_OpenRTSCamera);
+
+void FRTSScreenClusterGrid::Build(const FRTSScreenProjector& Projector, const TConstArrayView<FVector> Locations, const float InCellSize, const FRTSVisibilityGrid* VisibilityGrid)
+{
+	SCOPE_CYCLE_COUNTER(STAT_RTSScreenClustering);
+
+	CellSize = FMath::Max(InCellSize, 1.0f);
+	ClusterByCell.Reset();
+	Clusters.Reset();
+	Members.Reset();
+	ClusterByIndex.SetNumUninitialized(Locations.Num(), EAllowShrinking::No);
+	ScreenPositions.SetNumUninitialized(Locations.Num(), EAllowShrinking::No);
+
+	// First pass: project, hash into cells and accumulate the sums of each cluster
+	for (int32 Index = 0; Index < Locations.Num(); ++Index)
+	{
+		FVector2D& ScreenPosition = ScreenPositions[Index];
+		double Depth;
+		if ((VisibilityGrid && !VisibilityGrid->IsVisible(Locations[Index])) || !Projector.Project(Locations[Index], ScreenPosition, Depth) || !Projector.IsOnScreen(ScreenPosition))
+		{
+			ClusterByIndex[Index] = INDEX_NONE;
+			continue;
+		}
+
+		const int32 ClusterIndex = ClusterByCell.FindOrAdd(GetCell(ScreenPosition), Clusters.Num());
+		if (ClusterIndex == Clusters.Num())
+		{
+			Clusters.AddDefaulted();
+		}
+
+		FRTSScreenCluster& Cluster = Clusters[ClusterIndex];
+		Cluster.ScreenCenter += ScreenPosition;
+		Cluster.WorldCenter += Locations[Index];
+		++Cluster.NumMembers;
+		ClusterByIndex[Index] = ClusterIndex;
+	}
+
+	// Counting sort the members so each cluster owns a contiguous range
+	int32 Offset = 0;
+	for (FRTSScreenCluster& Cluster : Clusters)
+	{
+		Cluster.FirstMember = Offset;
+		Offset += Cluster.NumMembers;
+		Cluster.ScreenCenter /= Cluster.NumMembers;
+		Cluster.WorldCenter /= Cluster.NumMembers;
+		Cluster.NumMembers = 0;
+	}
+
+	Members.SetNumUninitialized(Offset);
+	for (int32 Index = 0; Index < Locations.Num(); ++Index)
+	{
+		const int32 ClusterIndex = ClusterByIndex[Index];
+		if (ClusterIndex == INDEX_NONE)
+		{
+			continue;
+		}
+
+		FRTSScreenCluster& Cluster = Clusters[ClusterIndex];
+		Members[Cluster.FirstMember + Cluster.NumMembers++] = Index;
+		Cluster.ScreenRadius = FMath::Max(Cluster.ScreenRadius, static_cast<float>(FVector2D::Distance(Cluster.ScreenCenter, ScreenPositions[Index])));
+	}
+}
+
+int32 FRTSScreenClusterGrid::FindClusterAt(const FVector2D& ScreenPosition) const
+{
+	const int32* Cluster = ClusterByCell.Find(GetCell(ScreenPosition));
+	return Cluster ? *Cluster : INDEX_NONE;
+}
@@ -0,0 +1,71 @@
+// Copyright 2024 Jesus Bracho All Rights Reserved.
+
+#include "RTSScreenProjector.h"
+
+#include "SceneView.h"
+#include "Engine/GameViewportClient.h"
+#include "Engine/LocalPlayer.h"
+#include "GameFramework/PlayerController.h"
+
+bool FRTSScreenProjector::Initialize(const APlayerController* PlayerController)
+{
+	const ULocalPlayer* LocalPlayer = PlayerController ? PlayerController->GetLocalPlayer() : nullptr;
+	if (LocalPlayer == nullptr || LocalPlayer->ViewportClient == nullptr)
+	{
+		return false;
+	}
+
+	FSceneViewProjectionData ProjectionData;
+	if (!LocalPlayer->GetProjectionData(LocalPlayer->ViewportClient->Viewport, ProjectionData))
+	{
+		return false;
+	}
+
+	ViewProjection = ProjectionData.ComputeViewProjectionMatrix();
+	InvViewProjection = ViewProjection.Inverse();
+	Projection = ProjectionData.ProjectionMatrix;
+	ViewOrigin = ProjectionData.ViewOrigin;
+	ViewRect = ProjectionData.GetConstrainedViewRect();
+	PixelsPerUnitAtUnitDepth = Projection.M[0][0] * 0.5 * ViewRect.Width();
+	return true;
+}
+
+FVector FRTSScreenProjector::Deproject(const FVector2D& ScreenPosition, const double DeviceZ) const
+{
+	const double X = (ScreenPosition.X - ViewRect.Min.X) / FMath::Max(ViewRect.Width(), 1) * 2.0 - 1.0;
+	const double Y = 1.0 - (ScreenPosition.Y - ViewRect.Min.Y) / FMath::Max(ViewRect.Height(), 1) * 2.0;
+	const FVector4 World = InvViewProjection.TransformFVector4(FVector4(X, Y, DeviceZ, 1.0));
+	return FVector(World) / World.W;
+}
+
+bool FRTSScreenProjector::DeprojectToHeight(const FVector2D& ScreenPosition, const double Height, FVector& OutLocation) const
+{
+	const FVector Near = Deproject(ScreenPosition, 1.0);
+	const FVector Direction = Deproject(ScreenPosition, 0.5) - Near;
+	if (Direction.Z >= -UE_KINDA_SMALL_NUMBER)
+	{
+		return false;
+	}
+
+	OutLocation = Near + Direction * ((Height - Near.Z) / Direction.Z);
+	return true;
+}
+
+void FRTSScreenProjector::DeprojectViewToHeight(const double Height, const double MaxDistance, FVector (&OutCorners)[4]) const
+{
+	const FVector2D ViewCorners[4] = {
+		FVector2D(ViewRect.Min.X, ViewRect.Min.Y), FVector2D(ViewRect.Max.X, ViewRect.Min.Y),
+		FVector2D(ViewRect.Max.X, ViewRect.Max.Y), FVector2D(ViewRect.Min.X, ViewRect.Max.Y)
+	};
+
+	for (int32 Corner = 0; Corner < 4; ++Corner)
+	{
+		FVector& Ground = OutCorners[Corner];
+		if (!DeprojectToHeight(ViewCorners[Corner], Height, Ground) || FVector::DistSquared2D(Ground, ViewOrigin) > FMath::Square(MaxDistance))
+		{
+			const FVector Near = Deproject(ViewCorners[Corner], 1.0);
+			Ground = Near + (Deproject(ViewCorners[Corner], 0.5) - Near).GetSafeNormal2D() * MaxDistance;
+			Ground.Z = Height;
+		}
+	}
+}
@@ -0,0 +1,56 @@
+// Copyright 2024 Jesus Bracho All Rights Reserved.
+
+#include "RTSSelectable.h"
+
+#include "RTSSelectableRegistry.h"
+#include "Engine/World.h"
+#include "Net/UnrealNetwork.h"
+
+URTSSelectable::URTSSelectable()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+	SetIsReplicatedByDefault(true);
+}
+
+void URTSSelectable::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	/** Ids never change after they were handed out */
+	DOREPLIFETIME_CONDITION(URTSSelectable, SelectableNetId, COND_InitialOnly);
+}
+
+void URTSSelectable::BeginPlay()
+{
+	Super::BeginPlay();
+	if (const auto Registry = GetWorld()->GetSubsystem<URTSSelectableRegistry>())
+	{
+		Registry->RegisterSelectable(GetOwner());
+		if (GetOwnerRole() == ROLE_Authority)
+		{
+			SelectableNetId = Registry->AssignNetId(GetOwner());
+		}
+		else if (SelectableNetId != INDEX_NONE)
+		{
+			Registry->BindNetId(GetOwner(), SelectableNetId);
+		}
+	}
+}
+
+void URTSSelectable::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (const auto Registry = GetWorld()->GetSubsystem<URTSSelectableRegistry>())
+	{
+		Registry->UnregisterSelectable(GetOwner());
+		Registry->ReleaseNetId(GetOwner());
+	}
+	Super::EndPlay(EndPlayReason);
+}
+
+void URTSSelectable::OnRep_SelectableNetId()
+{
+	if (const auto Registry = GetWorld()->GetSubsystem<URTSSelectableRegistry>())
+	{
+		Registry->BindNetId(GetOwner(), SelectableNetId);
+	}
+}
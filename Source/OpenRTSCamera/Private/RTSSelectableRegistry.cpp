@@ -0,0 +1,446 @@
+// Copyright 2024 Jesus Bracho All Rights Reserved.
+
+#include "RTSSelectableRegistry.h"
+
+#include "RTSCameraStats.h"
+#include "RTSEntitySelection.h"
+#include "Async/ParallelFor.h"
+#include "Interfaces/RTSSelection.h"
+#include "Components/SceneComponent.h"
+#include "Engine/Level.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+
+DECLARE_CYCLE_STAT(TEXT("Selectable Transform Sync"), STAT_RTSSelectableTransformSync, STATGROUP_OpenRTSCamera);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Selectable Transforms Synced"), STAT_RTSSelectableTransformsSynced, STATGROUP_OpenRTSCamera);
+
+void FRTSSelectableRegistryTickFunction::ExecuteTick(
+	const float DeltaTime,
+	ELevelTick TickType,
+	ENamedThreads::Type CurrentThread,
+	const FGraphEventRef& MyCompletionGraphEvent
+)
+{
+	if (Registry)
+	{
+		Registry->SyncTransforms();
+	}
+}
+
+FString FRTSSelectableRegistryTickFunction::DiagnosticMessage()
+{
+	return TEXT("URTSSelectableRegistry::SyncTransforms");
+}
+
+void URTSSelectableRegistry::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	/** Movement components tick pre physics, by now every unit has moved for this frame */
+	SyncTickFunction.Registry = this;
+	SyncTickFunction.TickGroup = TG_DuringPhysics;
+	SyncTickFunction.bCanEverTick = true;
+	SyncTickFunction.bStartWithTickEnabled = true;
+	SyncTickFunction.RegisterTickFunction(InWorld.PersistentLevel);
+}
+
+void URTSSelectableRegistry::Deinitialize()
+{
+	if (SyncTickFunction.IsTickFunctionRegistered())
+	{
+		SyncTickFunction.UnRegisterTickFunction();
+	}
+	SyncTickFunction.Registry = nullptr;
+	Super::Deinitialize();
+}
+
+void URTSSelectableRegistry::RegisterSelectable(AActor* Actor)
+{
+	if (Actor == nullptr || SlotByActor.Contains(Actor))
+	{
+		return;
+	}
+
+	FVector Origin;
+	FVector Extents;
+	Actor->GetActorBounds(true, Origin, Extents);
+
+	const int32 Slot = Actors.Add(Actor);
+	Locations.Add(Origin);
+	BoundsOffsets.Add(Origin - Actor->GetActorLocation());
+	BoundsRadii.Add(Extents.Size());
+	Significance.Add(UnassignedSignificance);
+	MovedLocations.Add(Actor->GetActorLocation());
+	Moved.Add(false);
+	SlotByActor.Add(Actor, Slot);
+
+	if (USceneComponent* RootComponent = Actor->GetRootComponent())
+	{
+		RootComponent->TransformUpdated.AddUObject(this, &URTSSelectableRegistry::HandleTransformUpdated);
+	}
+
+	int32& ClassId = ClassIdByClass.FindOrAdd(Actor->GetClass(), INDEX_NONE);
+	if (ClassId == INDEX_NONE)
+	{
+		ClassId = SlotsByClassId.AddDefaulted();
+		RulesByClassId.Add(CompileSelectionRule(Actor->GetClass()));
+		DispatchByClassId.Add(ResolveSelectionDispatch(Actor->GetClass()));
+	}
+	ClassIds.Add(ClassId);
+	ClassListIndices.Add(SlotsByClassId[ClassId].Add(Slot));
+
+	OnSelectableRegistered.Broadcast(Actor, Slot);
+}
+
+void URTSSelectableRegistry::UnregisterSelectable(AActor* Actor)
+{
+	if (const int32* Slot = SlotByActor.Find(Actor))
+	{
+		RemoveSlot(*Slot);
+	}
+}
+
+int32 URTSSelectableRegistry::FindSlot(const AActor* Actor) const
+{
+	const int32* Slot = SlotByActor.Find(Actor);
+	return Slot ? *Slot : INDEX_NONE;
+}
+
+void URTSSelectableRegistry::RefreshSlot(const int32 Slot)
+{
+	if (const auto Actor = Actors[Slot])
+	{
+		Locations[Slot] = Actor->GetActorLocation() + BoundsOffsets[Slot];
+	}
+}
+
+void URTSSelectableRegistry::HandleTransformUpdated(USceneComponent* Component, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport)
+{
+	if (const int32* Slot = SlotByActor.Find(Component->GetOwner()))
+	{
+		MovedLocations[*Slot] = Component->GetComponentLocation();
+		if (!Moved[*Slot])
+		{
+			Moved[*Slot] = true;
+			++NumMoved;
+		}
+	}
+}
+
+void URTSSelectableRegistry::SyncTransforms()
+{
+	if (NumMoved == 0)
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_RTSSelectableTransformSync);
+	const double StartTime = FPlatformTime::Seconds();
+
+	SyncSlots.Reset(NumMoved);
+	for (TConstSetBitIterator<> It(Moved); It; ++It)
+	{
+		SyncSlots.Add(It.GetIndex());
+	}
+
+	// Every chunk writes its own slots from the locations captured on the game thread, actors move while this runs
+	constexpr int32 ChunkSize = 1024;
+	const int32 NumChunks = FMath::DivideAndRoundUp(SyncSlots.Num(), ChunkSize);
+	ParallelFor(NumChunks, [this](const int32 Chunk)
+	{
+		const int32 End = FMath::Min((Chunk + 1) * ChunkSize, SyncSlots.Num());
+		for (int32 Index = Chunk * ChunkSize; Index < End; ++Index)
+		{
+			const int32 Slot = SyncSlots[Index];
+			Locations[Slot] = MovedLocations[Slot] + BoundsOffsets[Slot];
+		}
+	});
+
+	Moved.SetRange(0, Moved.Num(), false);
+	NumMoved = 0;
+
+	LastSyncedCount = SyncSlots.Num();
+	LastSyncMilliseconds = static_cast<float>((FPlatformTime::Seconds() - StartTime) * 1000.0);
+	INC_DWORD_STAT_BY(STAT_RTSSelectableTransformsSynced, LastSyncedCount);
+}
+
+void URTSSelectableRegistry::RemoveSlot(const int32 Slot)
+{
+	AActor* Actor = Actors[Slot];
+	OnSelectableUnregistered.Broadcast(Actor, Slot);
+
+	SlotByActor.Remove(Actor);
+	if (Actor && Actor->GetRootComponent())
+	{
+		Actor->GetRootComponent()->TransformUpdated.RemoveAll(this);
+	}
+	NumMoved -= Moved[Slot] ? 1 : 0;
+
+	/** Swap the slot out of its class list, then point the class list entry of the last slot at its new home */
+	TArray<int32>& ClassSlots = SlotsByClassId[ClassIds[Slot]];
+	const int32 ClassListIndex = ClassListIndices[Slot];
+	ClassSlots.RemoveAtSwap(ClassListIndex, 1, EAllowShrinking::No);
+	if (ClassSlots.IsValidIndex(ClassListIndex))
+	{
+		ClassListIndices[ClassSlots[ClassListIndex]] = ClassListIndex;
+	}
+
+	const int32 LastSlot = Actors.Num() - 1;
+	if (LastSlot != Slot)
+	{
+		SlotsByClassId[ClassIds[LastSlot]][ClassListIndices[LastSlot]] = Slot;
+	}
+
+	Actors.RemoveAtSwap(Slot, 1, EAllowShrinking::No);
+	Locations.RemoveAtSwap(Slot, 1, EAllowShrinking::No);
+	BoundsOffsets.RemoveAtSwap(Slot, 1, EAllowShrinking::No);
+	BoundsRadii.RemoveAtSwap(Slot, 1, EAllowShrinking::No);
+	Significance.RemoveAtSwap(Slot, 1, EAllowShrinking::No);
+	MovedLocations.RemoveAtSwap(Slot, 1, EAllowShrinking::No);
+	Moved.RemoveAtSwap(Slot);
+	ClassIds.RemoveAtSwap(Slot, 1, EAllowShrinking::No);
+	ClassListIndices.RemoveAtSwap(Slot, 1, EAllowShrinking::No);
+
+	/** The former last slot now lives in the freed one */
+	if (Actors.IsValidIndex(Slot))
+	{
+		SlotByActor.Add(Actors[Slot], Slot);
+	}
+}
+
+void URTSSelectableRegistry::SetSelectionRules(const TConstArrayView<FRTSSelectionRule> Rules)
+{
+	SelectionRules = TArray<FRTSSelectionRule>(Rules);
+	for (const auto& [Class, ClassId] : ClassIdByClass)
+	{
+		RulesByClassId[ClassId] = CompileSelectionRule(Class);
+	}
+}
+
+void URTSSelectableRegistry::SetBatchedSelectionHandler(const UClass* Class, TSharedPtr<IRTSBatchedSelectionHandler> Handler)
+{
+	if (Class == nullptr)
+	{
+		return;
+	}
+
+	if (Handler.IsValid())
+	{
+		BatchedHandlersByClass.Add(Class, MoveTemp(Handler));
+	}
+	else
+	{
+		BatchedHandlersByClass.Remove(Class);
+	}
+
+	for (const auto& [RegisteredClass, ClassId] : ClassIdByClass)
+	{
+		DispatchByClassId[ClassId] = ResolveSelectionDispatch(RegisteredClass);
+	}
+}
+
+FRTSSelectionDispatch URTSSelectableRegistry::ResolveSelectionDispatch(const UClass* Class) const
+{
+	FRTSSelectionDispatch Dispatch;
+	for (const UClass* Super = Class; Super && Dispatch.Handler == nullptr; Super = Super->GetSuperClass())
+	{
+		if (const TSharedPtr<IRTSBatchedSelectionHandler>* Handler = BatchedHandlersByClass.Find(Super))
+		{
+			Dispatch.Handler = Handler->Get();
+		}
+	}
+
+	Dispatch.bScriptOnSelected = Class->IsFunctionImplementedInScript(GET_FUNCTION_NAME_CHECKED(IRTSSelection, OnSelected));
+	Dispatch.bScriptOnDeselected = Class->IsFunctionImplementedInScript(GET_FUNCTION_NAME_CHECKED(IRTSSelection, OnDeselected));
+	return Dispatch;
+}
+
+void URTSSelectableRegistry::DispatchSelectionEvents(const TConstArrayView<AActor*> Selected, const TConstArrayView<AActor*> Deselected)
+{
+	DispatchSelectionEvent(Deselected, false);
+	DispatchSelectionEvent(Selected, true);
+}
+
+void URTSSelectableRegistry::DispatchSelectionEvent(const TConstArrayView<AActor*> Actors, const bool bSelected)
+{
+	if (BatchedHandlersByClass.Num() == 0)
+	{
+		for (AActor* Actor : Actors)
+		{
+			bSelected ? IRTSSelection::Execute_OnSelected(Actor) : IRTSSelection::Execute_OnDeselected(Actor);
+		}
+		return;
+	}
+
+	if (BatchesByClassId.Num() < DispatchByClassId.Num())
+	{
+		BatchesByClassId.SetNum(DispatchByClassId.Num());
+	}
+
+	// Bucket the units of classes with a handler, the rest (and Blueprint overrides) still get their event right away
+	for (AActor* Actor : Actors)
+	{
+		const int32 Slot = FindSlot(Actor);
+		if (Slot != INDEX_NONE)
+		{
+			const int32 ClassId = ClassIds[Slot];
+			const FRTSSelectionDispatch& Dispatch = DispatchByClassId[ClassId];
+			if (Dispatch.Handler)
+			{
+				TArray<AActor*>& Batch = BatchesByClassId[ClassId];
+				if (Batch.Num() == 0)
+				{
+					BatchedClassIds.Add(ClassId);
+				}
+				Batch.Add(Actor);
+
+				if (!(bSelected ? Dispatch.bScriptOnSelected : Dispatch.bScriptOnDeselected))
+				{
+					continue;
+				}
+			}
+		}
+
+		bSelected ? IRTSSelection::Execute_OnSelected(Actor) : IRTSSelection::Execute_OnDeselected(Actor);
+	}
+
+	for (const int32 ClassId : BatchedClassIds)
+	{
+		TArray<AActor*>& Batch = BatchesByClassId[ClassId];
+		IRTSBatchedSelectionHandler* Handler = DispatchByClassId[ClassId].Handler;
+		bSelected ? Handler->OnSelectedBatch(Batch) : Handler->OnDeselectedBatch(Batch);
+		Batch.Reset();
+	}
+	BatchedClassIds.Reset();
+}
+
+int32 URTSSelectableRegistry::AssignNetId(AActor* Actor)
+{
+	if (const int32* Existing = NetIdByActor.Find(Actor))
+	{
+		return *Existing;
+	}
+
+	int32 NetId;
+	if (FreeNetIds.Num() > 0)
+	{
+		FreeNetIds.HeapPop(NetId, EAllowShrinking::No);
+	}
+	else if (ActorsByNetId.Num() < MaxNetIds)
+	{
+		NetId = ActorsByNetId.AddZeroed();
+	}
+	else
+	{
+		return INDEX_NONE;
+	}
+
+	ActorsByNetId[NetId] = Actor;
+	NetIdByActor.Add(Actor, NetId);
+	return NetId;
+}
+
+void URTSSelectableRegistry::BindNetId(AActor* Actor, const int32 NetId)
+{
+	if (NetId < 0 || NetId >= MaxNetIds)
+	{
+		return;
+	}
+
+	ReleaseNetId(Actor);
+	if (ActorsByNetId.Num() <= NetId)
+	{
+		ActorsByNetId.AddZeroed(NetId + 1 - ActorsByNetId.Num());
+	}
+	ActorsByNetId[NetId] = Actor;
+	NetIdByActor.Add(Actor, NetId);
+}
+
+void URTSSelectableRegistry::ReleaseNetId(AActor* Actor)
+{
+	int32 NetId;
+	if (NetIdByActor.RemoveAndCopyValue(Actor, NetId))
+	{
+		/** On clients another actor may already have been bound to the id by the time we get here */
+		if (ActorsByNetId[NetId] == Actor)
+		{
+			ActorsByNetId[NetId] = nullptr;
+			if (GetWorld()->GetNetMode() != NM_Client)
+			{
+				if (NetIdClaims.IsValidIndex(NetId) && NetIdClaims[NetId] > 0)
+				{
+					QuarantinedNetIds[NetId] = true;
+				}
+				else
+				{
+					FreeNetIds.HeapPush(NetId);
+				}
+			}
+		}
+	}
+}
+
+void URTSSelectableRegistry::UpdateNetIdClaims(const TBitArray<>& Previous, const TBitArray<>& Current)
+{
+	const int32 NumBits = FMath::Max(Previous.Num(), Current.Num());
+	if (NetIdClaims.Num() < NumBits)
+	{
+		NetIdClaims.AddZeroed(NumBits - NetIdClaims.Num());
+		QuarantinedNetIds.Add(false, NumBits - QuarantinedNetIds.Num());
+	}
+
+	for (TConstSetBitIterator<> It(Current); It; ++It)
+	{
+		if (!Previous.IsValidIndex(It.GetIndex()) || !Previous[It.GetIndex()])
+		{
+			++NetIdClaims[It.GetIndex()];
+		}
+	}
+
+	for (TConstSetBitIterator<> It(Previous); It; ++It)
+	{
+		const int32 NetId = It.GetIndex();
+		if (Current.IsValidIndex(NetId) && Current[NetId])
+		{
+			continue;
+		}
+
+		if (NetIdClaims[NetId] > 0 && --NetIdClaims[NetId] == 0 && QuarantinedNetIds[NetId])
+		{
+			QuarantinedNetIds[NetId] = false;
+			FreeNetIds.HeapPush(NetId);
+		}
+	}
+}
+
+int32 URTSSelectableRegistry::GetNetId(const AActor* Actor) const
+{
+	const int32* NetId = NetIdByActor.Find(Actor);
+	return NetId ? *NetId : INDEX_NONE;
+}
+
+int32 URTSSelectableRegistry::RegisterEntitySource(URTSEntitySelectionSource* Source)
+{
+	const int32 Existing = EntitySources.Find(Source);
+	if (Source == nullptr || Existing != INDEX_NONE)
+	{
+		return Existing;
+	}
+
+	const int32 FreeId = EntitySources.Find(nullptr);
+	if (FreeId != INDEX_NONE)
+	{
+		EntitySources[FreeId] = Source;
+		return FreeId;
+	}
+	return EntitySources.Add(Source);
+}
+
+void URTSSelectableRegistry::UnregisterEntitySource(URTSEntitySelectionSource* Source)
+{
+	const int32 SourceId = EntitySources.Find(Source);
+	if (Source != nullptr && SourceId != INDEX_NONE)
+	{
+		EntitySources[SourceId] = nullptr;
+	}
+}
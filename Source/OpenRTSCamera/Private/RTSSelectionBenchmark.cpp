@@ -0,0 +1,108 @@
+// Copyright 2024 Jesus Bracho All Rights Reserved.
+
+#include "RTSSelectionBenchmark.h"
+
+#include "RTSSelectableRegistry.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+ARTSSelectionBenchmarkUnit::ARTSSelectionBenchmarkUnit()
+{
+	PrimaryActorTick.bCanEverTick = false;
+	SetCanBeDamaged(false);
+}
+
+#if !UE_BUILD_SHIPPING
+
+namespace
+{
+	class FBenchmarkUnitHandler final : public IRTSBatchedSelectionHandler
+	{
+	public:
+		virtual void OnSelectedBatch(const TConstArrayView<AActor*> Actors) override { SetSelected(Actors, true); }
+		virtual void OnDeselectedBatch(const TConstArrayView<AActor*> Actors) override { SetSelected(Actors, false); }
+
+	private:
+		// The registry only hands us units of the class the handler was registered for
+		static void SetSelected(const TConstArrayView<AActor*> Actors, const bool bSelected)
+		{
+			for (AActor* Actor : Actors)
+			{
+				static_cast<ARTSSelectionBenchmarkUnit*>(Actor)->bSelected = bSelected;
+			}
+		}
+	};
+
+	// Selects then deselects every unit, best of a few rounds so a cold first round does not skew the result
+	template <typename DispatchType>
+	double TimeSelectionRounds(const DispatchType& Dispatch)
+	{
+		constexpr int32 NumRounds = 8;
+		double Best = TNumericLimits<double>::Max();
+		for (int32 Round = 0; Round < NumRounds; ++Round)
+		{
+			const double Start = FPlatformTime::Seconds();
+			Dispatch(true);
+			Dispatch(false);
+			Best = FMath::Min(Best, FPlatformTime::Seconds() - Start);
+		}
+		return Best;
+	}
+
+	void RunSelectionDispatchBenchmark(const TArray<FString>& Args, UWorld* World)
+	{
+		URTSSelectableRegistry* Registry = World ? World->GetSubsystem<URTSSelectableRegistry>() : nullptr;
+		if (Registry == nullptr)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("RTS.BenchmarkSelectionDispatch needs a game world."));
+			return;
+		}
+
+		const int32 NumUnits = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 5000;
+
+		FActorSpawnParameters SpawnParameters;
+		SpawnParameters.ObjectFlags = RF_Transient;
+		SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+		TArray<AActor*> Units;
+		Units.Reserve(NumUnits);
+		for (int32 Unit = 0; Unit < NumUnits; ++Unit)
+		{
+			AActor* Actor = World->SpawnActor<ARTSSelectionBenchmarkUnit>(SpawnParameters);
+			Registry->RegisterSelectable(Actor);
+			Units.Add(Actor);
+		}
+
+		const double PerActorSeconds = TimeSelectionRounds([&Units](const bool bSelected)
+		{
+			for (AActor* Actor : Units)
+			{
+				bSelected ? IRTSSelection::Execute_OnSelected(Actor) : IRTSSelection::Execute_OnDeselected(Actor);
+			}
+		});
+
+		Registry->SetBatchedSelectionHandler(ARTSSelectionBenchmarkUnit::StaticClass(), MakeShared<FBenchmarkUnitHandler>());
+		const double BatchedSeconds = TimeSelectionRounds([Registry, &Units](const bool bSelected)
+		{
+			bSelected ? Registry->DispatchSelectionEvents(Units, {}) : Registry->DispatchSelectionEvents({}, Units);
+		});
+		Registry->SetBatchedSelectionHandler(ARTSSelectionBenchmarkUnit::StaticClass(), nullptr);
+
+		for (AActor* Actor : Units)
+		{
+			Registry->UnregisterSelectable(Actor);
+			Actor->Destroy();
+		}
+
+		UE_LOG(LogTemp, Display, TEXT("Selecting and deselecting %d units: %.3f ms through the interface events, %.3f ms through the batched handler (%.1fx)."),
+			NumUnits, PerActorSeconds * 1000.0, BatchedSeconds * 1000.0, BatchedSeconds > 0 ? PerActorSeconds / BatchedSeconds : 0.0);
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs GRTSBenchmarkSelectionDispatchCommand(
+	TEXT("RTS.BenchmarkSelectionDispatch"),
+	TEXT("Spawns N native units (5000 by default) and times selecting and deselecting them through the per actor interface events and through a batched selection handler"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunSelectionDispatchBenchmark)
+);
+
+#endif
@@ -0,0 +1,24 @@
+// Copyright 2024 Jesus Bracho All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "Interfaces/RTSSelection.h"
+#include "RTSSelectionBenchmark.generated.h"
+
+/** Minimal native unit spawned by RTS.BenchmarkSelectionDispatch, both dispatch paths only flip its flag.
+ * UHT cannot compile a UCLASS out, so the class is still there in Shipping but the command that spawns it is not */
+UCLASS(Transient, NotBlueprintable, NotPlaceable)
+class ARTSSelectionBenchmarkUnit : public AActor, public IRTSSelection
+{
+	GENERATED_BODY()
+
+public:
+	ARTSSelectionBenchmarkUnit();
+
+	virtual void OnSelected_Implementation() override { bSelected = true; }
+	virtual void OnDeselected_Implementation() override { bSelected = false; }
+
+	bool bSelected = false;
+};
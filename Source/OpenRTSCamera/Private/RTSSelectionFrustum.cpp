@@ -0,0 +1,76 @@
+// Copyright 2024 Jesus Bracho All Rights Reserved.
+
+#include "RTSSelectionFrustum.h"
+
+#include "RTSCameraStats.h"
+#include "RTSScreenProjector.h"
+#include "RTSVisibilityGrid.h"
+
+DECLARE_CYCLE_STAT(TEXT("Selection Frustum Classify"), STAT_RTSSelectionFrustumClassify, STATGROUP_OpenRTSCamera);
+
+bool FRTSSelectionFrustum::Build(const FRTSScreenProjector& Projector, const FVector2D& FirstPoint, const FVector2D& SecondPoint)
+{
+	const FVector2D Min = FVector2D::Min(FirstPoint, SecondPoint);
+	const FVector2D Max = FVector2D::Max(FirstPoint, SecondPoint);
+	if (Max.X - Min.X < 1.0 || Max.Y - Min.Y < 1.0 || Projector.ViewRect.Area() <= 0)
+	{
+		return false;
+	}
+
+	// Depth is reversed, 1 is the near plane. Any second depth in front of the camera gives the direction of the edges
+	constexpr double NearZ = 1.0;
+	constexpr double FarZ = 0.5;
+	const FVector2D Corners[4] = {Min, FVector2D(Max.X, Min.Y), Max, FVector2D(Min.X, Max.Y)};
+	FVector Near[4];
+	FVector Far[4];
+	for (int32 Corner = 0; Corner < 4; ++Corner)
+	{
+		Near[Corner] = Projector.Deproject(Corners[Corner], NearZ);
+		Far[Corner] = Projector.Deproject(Corners[Corner], FarZ);
+	}
+
+	for (int32 Corner = 0; Corner < 4; ++Corner)
+	{
+		Planes[Corner] = FPlane(Near[Corner], Far[Corner], Near[(Corner + 1) % 4]);
+	}
+	Planes[4] = FPlane(Near[0], Near[2], Near[1]);
+
+	// Whatever the handedness of the corners, flip the planes that do not face away from a point inside the box
+	const FVector Inside = Projector.Deproject((Min + Max) * 0.5, (NearZ + FarZ) * 0.5);
+	for (FPlane& Plane : Planes)
+	{
+		if (Plane.PlaneDot(Inside) > 0)
+		{
+			Plane = Plane.Flip();
+		}
+	}
+	return true;
+}
+
+void FRTSSelectionFrustum::Classify(const TConstArrayView<FVector> Centers, const TConstArrayView<float> Radii, const ERTSBoxSelectionTest Test, TArray<int32>& OutIndices,
+                                    const FRTSVisibilityGrid* VisibilityGrid) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_RTSSelectionFrustumClassify);
+	check(Centers.Num() == Radii.Num());
+
+	if (VisibilityGrid == nullptr)
+	{
+		for (int32 Index = 0; Index < Centers.Num(); ++Index)
+		{
+			if (Passes(Centers[Index], Radii[Index], Test))
+			{
+				OutIndices.Add(Index);
+			}
+		}
+		return;
+	}
+
+	// The fog bit is cheaper than the planes, and under a thick fog it rejects most units
+	for (int32 Index = 0; Index < Centers.Num(); ++Index)
+	{
+		if (VisibilityGrid->IsVisible(Centers[Index]) && Passes(Centers[Index], Radii[Index], Test))
+		{
+			OutIndices.Add(Index);
+		}
+	}
+}
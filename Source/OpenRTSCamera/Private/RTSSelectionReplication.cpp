@@ -0,0 +1,119 @@
+// Copyright 2024 Jesus Bracho All Rights Reserved.
+
+#include "RTSSelectionReplication.h"
+
+#include "Serialization/BitReader.h"
+#include "Serialization/BitWriter.h"
+
+void FRTSSelectionBitsetCodec::WriteRuns(FBitWriter& Writer, const TBitArray<>& Bits)
+{
+	TArray<uint32, TInlineAllocator<32>> Runs;
+	bool bRunValue = false;
+	uint32 RunLength = 0;
+	int32 LastSetBit = INDEX_NONE;
+
+	for (TConstSetBitIterator<> It(Bits); It; ++It)
+	{
+		LastSetBit = It.GetIndex();
+	}
+
+	for (int32 Index = 0; Index <= LastSetBit; ++Index)
+	{
+		if (Bits[Index] != bRunValue)
+		{
+			Runs.Add(RunLength);
+			bRunValue = !bRunValue;
+			RunLength = 0;
+		}
+		++RunLength;
+	}
+
+	if (LastSetBit != INDEX_NONE)
+	{
+		Runs.Add(RunLength);
+	}
+
+	uint32 NumRuns = Runs.Num();
+	Writer.SerializeIntPacked(NumRuns);
+	for (uint32& Run : Runs)
+	{
+		Writer.SerializeIntPacked(Run);
+	}
+}
+
+bool FRTSSelectionBitsetCodec::ReadRuns(FBitReader& Reader, const int32 MaxBits, TBitArray<>& OutBits)
+{
+	OutBits.Reset();
+
+	uint32 NumRuns = 0;
+	Reader.SerializeIntPacked(NumRuns);
+	if (Reader.IsError() || NumRuns > static_cast<uint32>(MaxBits) + 1)
+	{
+		return false;
+	}
+
+	bool bRunValue = false;
+	for (uint32 RunIndex = 0; RunIndex < NumRuns; ++RunIndex)
+	{
+		uint32 RunLength = 0;
+		Reader.SerializeIntPacked(RunLength);
+		if (Reader.IsError() || static_cast<int64>(OutBits.Num()) + RunLength > MaxBits)
+		{
+			return false;
+		}
+
+		OutBits.Add(bRunValue, RunLength);
+		bRunValue = !bRunValue;
+	}
+	return true;
+}
+
+bool FRTSSelectionBitsetCodec::HasDifferences(const TBitArray<>& Previous, const TBitArray<>& Current)
+{
+	const int32 NumBits = FMath::Max(Previous.Num(), Current.Num());
+	for (int32 Index = 0; Index < NumBits; ++Index)
+	{
+		const bool bPrevious = Previous.IsValidIndex(Index) && Previous[Index];
+		const bool bCurrent = Current.IsValidIndex(Index) && Current[Index];
+		if (bPrevious != bCurrent)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void FRTSSelectionBitsetCodec::WriteDelta(FBitWriter& Writer, const TBitArray<>& Previous, const TBitArray<>& Current)
+{
+	const int32 NumBits = FMath::Max(Previous.Num(), Current.Num());
+	TBitArray<> Flipped(false, NumBits);
+	for (TConstSetBitIterator<> It(Previous); It; ++It)
+	{
+		Flipped[It.GetIndex()] = true;
+	}
+	for (TConstSetBitIterator<> It(Current); It; ++It)
+	{
+		Flipped[It.GetIndex()] = !Flipped[It.GetIndex()];
+	}
+	WriteRuns(Writer, Flipped);
+}
+
+bool FRTSSelectionBitsetCodec::ReadDelta(FBitReader& Reader, const int32 MaxBits, TBitArray<>& InOutBits)
+{
+	TBitArray<> Flipped;
+	if (!ReadRuns(Reader, MaxBits, Flipped))
+	{
+		return false;
+	}
+
+	if (InOutBits.Num() < Flipped.Num())
+	{
+		InOutBits.Add(false, Flipped.Num() - InOutBits.Num());
+	}
+
+	for (TConstSetBitIterator<> It(Flipped); It; ++It)
+	{
+		InOutBits[It.GetIndex()] = !InOutBits[It.GetIndex()];
+	}
+	return true;
+}
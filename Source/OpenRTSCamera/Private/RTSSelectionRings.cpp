@@ -0,0 +1,279 @@
+// Copyright 2024 Jesus Bracho All Rights Reserved.
+
+#include "RTSSelectionRings.h"
+
+#include "RTSCameraStats.h"
+#include "RTSSelectableRegistry.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/World.h"
+#include "Materials/MaterialInterface.h"
+
+DECLARE_CYCLE_STAT(TEXT("Selection Rings Update"), STAT_RTSSelectionRingsUpdate, STATGROUP_OpenRTSCamera);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Selection Rings Uploaded"), STAT_RTSSelectionRingsUploaded, STATGROUP_OpenRTSCamera);
+
+int32 FRTSSelectionRingBuffer::Add(const void* Key, const FTransform& Transform)
+{
+	if (const int32* Existing = IndexByKey.Find(Key))
+	{
+		return *Existing;
+	}
+
+	const int32 Index = Keys.Add(Key);
+	Transforms.Add(Transform);
+	IndexByKey.Add(Key, Index);
+	MarkDirty(Index);
+	return Index;
+}
+
+bool FRTSSelectionRingBuffer::Remove(const void* Key)
+{
+	int32 Index;
+	if (!IndexByKey.RemoveAndCopyValue(Key, Index))
+	{
+		return false;
+	}
+
+	Keys.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Transforms.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	if (Keys.IsValidIndex(Index))
+	{
+		IndexByKey.Add(Keys[Index], Index);
+		MarkDirty(Index);
+	}
+
+	/** The dirty range must never point past the end, the trailing instance is dropped rather than uploaded */
+	LastDirty = FMath::Min(LastDirty, Keys.Num() - 1);
+	if (LastDirty < FirstDirty)
+	{
+		ClearDirty();
+	}
+	return true;
+}
+
+bool FRTSSelectionRingBuffer::Update(const int32 Index, const FTransform& Transform, const float Tolerance)
+{
+	FTransform& Current = Transforms[Index];
+	if (Current.GetLocation().Equals(Transform.GetLocation(), Tolerance) && Current.GetScale3D().Equals(Transform.GetScale3D(), UE_KINDA_SMALL_NUMBER))
+	{
+		return false;
+	}
+
+	Current = Transform;
+	MarkDirty(Index);
+	return true;
+}
+
+int32 FRTSSelectionRingBuffer::Find(const void* Key) const
+{
+	const int32* Index = IndexByKey.Find(Key);
+	return Index ? *Index : INDEX_NONE;
+}
+
+void FRTSSelectionRingBuffer::ClearDirty()
+{
+	FirstDirty = MAX_int32;
+	LastDirty = INDEX_NONE;
+}
+
+void FRTSSelectionRingBuffer::MarkDirty(const int32 Index)
+{
+	FirstDirty = FMath::Min(FirstDirty, Index);
+	LastDirty = FMath::Max(LastDirty, Index);
+}
+
+void URTSSelectionRingSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+	Registry = Collection.InitializeDependency<URTSSelectableRegistry>();
+	UnregisteredHandle = Registry->OnSelectableUnregistered.AddUObject(this, &URTSSelectionRingSubsystem::HandleSelectableUnregistered);
+}
+
+void URTSSelectionRingSubsystem::Deinitialize()
+{
+	if (Registry)
+	{
+		Registry->OnSelectableUnregistered.Remove(UnregisteredHandle);
+	}
+	Super::Deinitialize();
+}
+
+TStatId URTSSelectionRingSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(URTSSelectionRingSubsystem, STATGROUP_OpenRTSCamera);
+}
+
+void URTSSelectionRingSubsystem::SetSelectedActors(const URTSSelector* Selector, const TArray<AActor*>& Actors)
+{
+	TArray<const AActor*>& Selection = SelectionBySelector.FindOrAdd(Selector);
+
+	/** Add first so units that stay selected never drop to zero references */
+	for (AActor* Actor : Actors)
+	{
+		if (IsValid(Actor))
+		{
+			AddRing(Actor);
+		}
+	}
+	for (const AActor* Actor : Selection)
+	{
+		RemoveRing(Actor);
+	}
+
+	Selection.Reset();
+	for (const AActor* Actor : Actors)
+	{
+		if (IsValid(Actor))
+		{
+			Selection.Add(Actor);
+		}
+	}
+}
+
+void URTSSelectionRingSubsystem::AddRing(AActor* Actor)
+{
+	FRing& Ring = Rings.FindOrAdd(Actor);
+	if (Ring.RefCount++ > 0)
+	{
+		return;
+	}
+
+	/** Place the ring under the bounds, sized to their horizontal extent */
+	FVector Origin;
+	FVector Extents;
+	Actor->GetActorBounds(true, Origin, Extents);
+	Ring.Actor = Actor;
+	Ring.Offset = Origin - Actor->GetActorLocation();
+	Ring.Offset.Z -= Extents.Z - RingHeightOffset;
+	Ring.Scale = FMath::Max(FMath::Max(Extents.X, Extents.Y) * 2.0f * RingScale / 100.0f, UE_KINDA_SMALL_NUMBER);
+
+	Buffer.Add(Actor, GetRingTransform(Actor, Ring));
+}
+
+void URTSSelectionRingSubsystem::RemoveRing(const AActor* Actor)
+{
+	FRing* Ring = Rings.Find(Actor);
+	if (Ring && --Ring->RefCount <= 0)
+	{
+		Rings.Remove(Actor);
+		Buffer.Remove(Actor);
+	}
+}
+
+void URTSSelectionRingSubsystem::DiscardRing(const AActor* Actor)
+{
+	if (Rings.Remove(Actor) > 0)
+	{
+		Buffer.Remove(Actor);
+		for (auto& [Selector, Selection] : SelectionBySelector)
+		{
+			Selection.RemoveSwap(Actor, EAllowShrinking::No);
+		}
+	}
+}
+
+void URTSSelectionRingSubsystem::HandleSelectableUnregistered(AActor* Actor, int32 Slot)
+{
+	DiscardRing(Actor);
+}
+
+FTransform URTSSelectionRingSubsystem::GetRingTransform(const AActor* Actor, const FRing& Ring) const
+{
+	return FTransform(FQuat::Identity, Actor->GetActorLocation() + Ring.Offset, FVector(Ring.Scale, Ring.Scale, 1.0f));
+}
+
+void URTSSelectionRingSubsystem::Tick(const float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+	SCOPE_CYCLE_COUNTER(STAT_RTSSelectionRingsUpdate);
+
+	if (Buffer.Num() == 0 && (RingComponent == nullptr || RingComponent->GetInstanceCount() == 0))
+	{
+		return;
+	}
+
+	/** Walk backwards so discarding a ring only swaps in one that was already visited */
+	for (int32 Index = Buffer.Num() - 1; Index >= 0; --Index)
+	{
+		const AActor* Key = static_cast<const AActor*>(Buffer.GetKey(Index));
+		const FRing& Ring = Rings.FindChecked(Key);
+		if (const AActor* Actor = Ring.Actor.Get())
+		{
+			Buffer.Update(Index, GetRingTransform(Actor, Ring), MoveTolerance);
+		}
+		else
+		{
+			DiscardRing(Key);
+		}
+	}
+
+	UploadInstances();
+}
+
+bool URTSSelectionRingSubsystem::EnsureRingComponent()
+{
+	if (RingComponent)
+	{
+		return true;
+	}
+
+	UWorld* World = GetWorld();
+	if (World == nullptr || World->GetNetMode() == NM_DedicatedServer)
+	{
+		return false;
+	}
+
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.ObjectFlags |= RF_Transient;
+	AActor* RingActor = World->SpawnActor<AActor>(SpawnParameters);
+	if (RingActor == nullptr)
+	{
+		return false;
+	}
+
+	RingComponent = NewObject<UInstancedStaticMeshComponent>(RingActor, TEXT("SelectionRings"));
+	RingComponent->SetMobility(EComponentMobility::Movable);
+	RingComponent->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	RingComponent->SetCastShadow(false);
+	RingComponent->SetStaticMesh(RingMesh.LoadSynchronous());
+	RingComponent->SetMaterial(0, RingMaterial.LoadSynchronous());
+	RingActor->SetRootComponent(RingComponent);
+	RingComponent->RegisterComponent();
+	return true;
+}
+
+void URTSSelectionRingSubsystem::UploadInstances()
+{
+	if (!EnsureRingComponent())
+	{
+		return;
+	}
+
+	const TArray<FTransform>& Transforms = Buffer.GetTransforms();
+	const int32 InstanceCount = RingComponent->GetInstanceCount();
+
+	/** Rings are swap-removed, so surplus instances are always at the end and dropping them moves nothing */
+	if (InstanceCount > Transforms.Num())
+	{
+		TArray<int32> Surplus;
+		for (int32 Index = Transforms.Num(); Index < InstanceCount; ++Index)
+		{
+			Surplus.Add(Index);
+		}
+		RingComponent->RemoveInstances(Surplus);
+	}
+	else if (InstanceCount < Transforms.Num())
+	{
+		RingComponent->AddInstances(TArray<FTransform>(&Transforms[InstanceCount], Transforms.Num() - InstanceCount), false, true);
+	}
+
+	/** Everything that moved goes up in one contiguous batch */
+	if (Buffer.IsDirty())
+	{
+		const int32 FirstDirty = Buffer.GetFirstDirty();
+		const int32 NumDirty = Buffer.GetLastDirty() - FirstDirty + 1;
+		RingComponent->BatchUpdateInstancesTransforms(FirstDirty, TArray<FTransform>(&Transforms[FirstDirty], NumDirty), true, true, true);
+		INC_DWORD_STAT_BY(STAT_RTSSelectionRingsUploaded, NumDirty);
+		Buffer.ClearDirty();
+	}
+}
@@ -0,0 +1,25 @@
+// Copyright 2024 Jesus Bracho All Rights Reserved.
+
+#include "RTSSelectionRules.h"
+
+#include "GameFramework/Actor.h"
+
+FRTSCompiledSelectionRule FRTSCompiledSelectionRule::Compile(const TConstArrayView<FRTSSelectionRule> Rules, const UClass* Class)
+{
+	FRTSCompiledSelectionRule Compiled;
+	const AActor* Defaults = Class ? Cast<AActor>(Class->GetDefaultObject()) : nullptr;
+	for (const FRTSSelectionRule& Rule : Rules)
+	{
+		if ((Rule.ActorClass && (!Class || !Class->IsChildOf(Rule.ActorClass)))
+			|| (!Rule.ClassTag.IsNone() && (!Defaults || !Defaults->Tags.Contains(Rule.ClassTag))))
+		{
+			continue;
+		}
+
+		Compiled.Priority = Rule.Priority;
+		Compiled.Flags = (Rule.bSelectOnlyWhenAlone ? ERTSSelectionRuleFlags::OnlyWhenAlone : ERTSSelectionRuleFlags::None)
+			| (Rule.bNeverSelect ? ERTSSelectionRuleFlags::NeverSelect : ERTSSelectionRuleFlags::None);
+		break;
+	}
+	return Compiled;
+}
@@ -3,84 +3,530 @@
 #include "RTSSelector.h"
 
 #include "EnhancedInputComponent.h"
+#include "Engine/AssetManager.h"
 #include "EnhancedInputSubsystems.h"
 #include "Kismet/GameplayStatics.h"
+#include "RTSCamera.h"
+#include "RTSCameraStats.h"
 #include "RTSHUD.h"
+#include "RTSScreenProjector.h"
+#include "RTSSelectableRegistry.h"
+#include "RTSSelectionReplication.h"
+#include "RTSSelectionRings.h"
+#include "Async/ParallelFor.h"
+#include <algorithm>
 #include "Interfaces/RTSSelection.h"
+#include "Serialization/BitReader.h"
+#include "Serialization/BitWriter.h"
 
-URTSSelector::URTSSelector(): PlayerController(nullptr), HUD(nullptr), bIsSelecting(false)
+DECLARE_CYCLE_STAT(TEXT("Entity Selection Query"), STAT_RTSEntitySelectionQuery, STATGROUP_OpenRTSCamera);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Selection Replication Bytes"), STAT_RTSSelectionReplicationBytes, STATGROUP_OpenRTSCamera);
+
+URTSSelector::URTSSelector():
+	bReplicateSelection(false),
+	bAllowSelectingUnownedActors(false),
+	PlayerController(nullptr),
+	HUD(nullptr),
+	bIsSelecting(false),
+	Registry(nullptr),
+	CameraSubsystem(nullptr),
+	SelectionRings(nullptr),
+	LastClickedActor(nullptr)
 {
 	// Set this component to be initialized when the game starts, and to be ticked every frame.  You can turn these features
 	// off to improve performance if you don't need them.
 	PrimaryComponentTick.bCanEverTick = true;
 
-	// Add defaults for input actions
-	static ConstructorHelpers::FObjectFinder<UInputAction>
-		BeginSelectionActionFinder(TEXT("/OpenRTSCamera/Inputs/BeginSelection"));
-	static ConstructorHelpers::FObjectFinder<UInputMappingContext>
-		InputMappingContextFinder(TEXT("/OpenRTSCamera/Inputs/OpenRTSCameraInputs")); 
-	BeginSelection = BeginSelectionActionFinder.Object;
-	InputMappingContext = InputMappingContextFinder.Object;
+	bEnableClickSelection = true;
+	ClickDragThreshold = 5.0f;
+	ClickTolerance = 4.0f;
+	DoubleClickTime = 0.3f;
+	bKeepOnlyHighestPriority = false;
+	MaxSelectedUnits = 0;
+	bShowSelectionRings = false;
+	bBoxSelectFromRegistry = true;
+	BoxSelectionTest = ERTSBoxSelectionTest::AnyOverlap;
+	bEnableClustering = false;
+	ClusterZoomLength = 4000.0f;
+	ClusterCellSize = 32.0f;
+
+	// Needed for the selection RPCs, there are no replicated properties so this costs nothing unless bReplicateSelection is set
+	SetIsReplicatedByDefault(true);
+
+	// Only the paths, the assets are streamed in on BeginPlay
+	BeginSelection = TSoftObjectPtr<UInputAction>(FSoftObjectPath(TEXT("/OpenRTSCamera/Inputs/BeginSelection.BeginSelection")));
+	InputMappingContext = TSoftObjectPtr<UInputMappingContext>(FSoftObjectPath(TEXT("/OpenRTSCamera/Inputs/OpenRTSCameraInputs.OpenRTSCameraInputs")));
 }
 
 
 void URTSSelector::BeginPlay()
 {
 	Super::BeginPlay();
+	Registry = GetWorld()->GetSubsystem<URTSSelectableRegistry>();
+	CameraSubsystem = GetWorld()->GetSubsystem<URTSCameraSubsystem>();
+	SelectionRings = GetWorld()->GetSubsystem<URTSSelectionRingSubsystem>();
+	if (Registry)
+	{
+		SelectableUnregisteredHandle = Registry->OnSelectableUnregistered.AddUObject(this, &URTSSelector::HandleSelectableUnregistered);
+		if (SelectionRules.Num() > 0)
+		{
+			Registry->SetSelectionRules(SelectionRules);
+		}
+	}
+
+	/** Needed in every net mode, the server validates replicated selections against the controller that owns us */
+	PlayerController = Cast<APlayerController>(GetOwner());
 
 	if (const auto NetMode = GetNetMode() != NM_DedicatedServer)
 	{
 		CollectComponentDependencyReferences();
-		BindInputMappingContext();
-		BindInputActions();
+		if (CameraSubsystem && PlayerController && PlayerController->IsLocalController())
+		{
+			CameraSubsystem->RequestCursorTracking(PlayerController);
+		}
+		RequestInputAssets();
 		OnActorsSelected.AddDynamic(this, &URTSSelector::HandleSelectedActors);
 	}
 }
 
+void URTSSelector::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (Registry)
+	{
+		Registry->OnSelectableUnregistered.Remove(SelectableUnregisteredHandle);
+	}
+	if (SelectionRings)
+	{
+		SelectionRings->SetSelectedActors(this, TArray<AActor*>());
+	}
+	if (Registry && GetOwnerRole() == ROLE_Authority)
+	{
+		Registry->UpdateNetIdClaims(ReplicatedSelectionBits, TBitArray<>());
+	}
+	if (InputAssetsHandle)
+	{
+		InputAssetsHandle->CancelHandle();
+		InputAssetsHandle.Reset();
+	}
+	LoadedInputAssets.Reset();
+	Super::EndPlay(EndPlayReason);
+}
+
 void URTSSelector::HandleSelectedActors_Implementation(const TArray<AActor*>& NewSelectedActors)
 {
-	// Convert NewSelectedActors to a set for efficient lookup
-	TSet<AActor*> FilteredSelectedActors;
-	
+	TArray<AActor*> Candidates;
+	Candidates.Reserve(NewSelectedActors.Num());
 	for (AActor* Actor : NewSelectedActors)
 	{
 		if (Actor && Actor->Implements<URTSSelection>())
 		{
-			FilteredSelectedActors.Add(Actor);
+			Candidates.Add(Actor);
 		}
 	}
+	ApplySelectionRules(Candidates);
 
-	// Iterate over currently selected actors and deselect those that are no longer selected.
-	for (AActor* Selected : SelectedActors)
+	// Mark the units that stay selected, everything left unmarked is deselected
+	TBitArray<> Kept(false, SelectedActors.Num());
+	TArray<AActor*> AddedActors;
+	for (AActor* Actor : Candidates)
 	{
-		if (Selected && !FilteredSelectedActors.Contains(Selected))
+		if (const int32* Index = SelectedIndexByActor.Find(Actor))
 		{
-			if (Selected && Selected->Implements<URTSSelection>())
-			{
-				IRTSSelection::Execute_OnDeselected(Selected);
-			}
+			Kept[*Index] = true;
+		}
+		else
+		{
+			AddedActors.Add(Actor);
 		}
 	}
 
-	// Clear the current selection AFTER deselecting actors
-	SelectedActors.Empty();	
-	
-	// Add new selected actors and call OnSelected
-	for (AActor* Actor : FilteredSelectedActors)
+	// Walking backwards, whatever gets swapped into a freed index has been visited already and was kept
+	TArray<AActor*> RemovedActors;
+	for (int32 Index = Kept.Num() - 1; Index >= 0; --Index)
 	{
-		SelectedActors.Add(Actor);
-		IRTSSelection::Execute_OnSelected(Actor);
+		if (!Kept[Index])
+		{
+			AActor* Deselected = SelectedActors[Index];
+			RemoveSelectedActorAt(Index);
+			RemovedActors.Add(Deselected);
+		}
+	}
+
+	// Candidates may contain the same actor twice, the membership check drops the second one
+	AddedActors.RemoveAllSwap([this](AActor* Actor)
+	{
+		if (IsActorSelected(Actor))
+		{
+			return true;
+		}
+		AddSelectedActor(Actor);
+		return false;
+	}, EAllowShrinking::No);
+
+	DispatchSelectionEvents(AddedActors, RemovedActors);
+
+	if (AddedActors.Num() > 0 || RemovedActors.Num() > 0)
+	{
+		OnSelectionChanged.Broadcast(AddedActors, RemovedActors);
+		NotifySelectionChanged();
+	}
+}
+
+void URTSSelector::TickComponent(const float DeltaTime, const ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	if (bSelectionPruned)
+	{
+		bSelectionPruned = false;
+		NotifySelectionChanged();
+	}
+}
+
+void URTSSelector::AddSelectedActor(AActor* Actor)
+{
+	SelectedIndexByActor.Add(Actor, SelectedActors.Add(Actor));
+	if (Registry == nullptr || Registry->FindSlot(Actor) == INDEX_NONE)
+	{
+		Actor->OnEndPlay.AddUniqueDynamic(this, &URTSSelector::OnSelectedActorEndPlay);
+	}
+}
+
+void URTSSelector::RemoveSelectedActorAt(const int32 Index)
+{
+	AActor* Actor = SelectedActors[Index];
+	SelectedIndexByActor.Remove(Actor);
+	if (Actor)
+	{
+		Actor->OnEndPlay.RemoveDynamic(this, &URTSSelector::OnSelectedActorEndPlay);
+	}
+
+	SelectedActors.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	if (SelectedActors.IsValidIndex(Index))
+	{
+		SelectedIndexByActor[SelectedActors[Index]] = Index;
+	}
+}
+
+void URTSSelector::PruneSelectedActor(AActor* Actor)
+{
+	const int32* Index = SelectedIndexByActor.Find(Actor);
+	if (Index == nullptr)
+	{
+		return;
+	}
+
+	RemoveSelectedActorAt(*Index);
+	DispatchSelectionEvents({}, MakeArrayView(&Actor, 1));
+	OnSelectionChanged.Broadcast(TArray<AActor*>(), TArray<AActor*>{Actor});
+
+	// Units tend to die in batches, the rings and the server hear about all of them at once
+	bSelectionPruned = true;
+}
+
+void URTSSelector::HandleSelectableUnregistered(AActor* Actor, int32 Slot)
+{
+	PruneSelectedActor(Actor);
+}
+
+void URTSSelector::OnSelectedActorEndPlay(AActor* Actor, EEndPlayReason::Type EndPlayReason)
+{
+	PruneSelectedActor(Actor);
+}
+
+void URTSSelector::ApplySelectionRules(TArray<AActor*>& Actors) const
+{
+	const bool bHasRules = Registry && Registry->HasSelectionRules();
+	if (!bHasRules && (MaxSelectedUnits <= 0 || Actors.Num() <= MaxSelectedUnits))
+	{
+		return;
+	}
+
+	struct FCandidate
+	{
+		AActor* Actor;
+		int32 Priority;
+		bool bOnlyWhenAlone;
+	};
+
+	// Resolve each unit's compiled rule once, tracking what the filters below need along the way
+	TArray<FCandidate> Candidates;
+	Candidates.Reserve(Actors.Num());
+	int32 HighestPriority = MIN_int32;
+	int32 HighestRegularPriority = MIN_int32;
+	bool bAnyRegular = false;
+	for (AActor* Actor : Actors)
+	{
+		FRTSCompiledSelectionRule Rule;
+		if (bHasRules)
+		{
+			const int32 Slot = Registry->FindSlot(Actor);
+			Rule = Slot != INDEX_NONE ? Registry->GetSelectionRule(Registry->GetClassId(Slot)) : Registry->CompileSelectionRule(Actor->GetClass());
+		}
+
+		if (EnumHasAnyFlags(Rule.Flags, ERTSSelectionRuleFlags::NeverSelect))
+		{
+			continue;
+		}
+
+		const bool bOnlyWhenAlone = EnumHasAnyFlags(Rule.Flags, ERTSSelectionRuleFlags::OnlyWhenAlone);
+		Candidates.Add({Actor, Rule.Priority, bOnlyWhenAlone});
+		HighestPriority = FMath::Max(HighestPriority, Rule.Priority);
+		if (!bOnlyWhenAlone)
+		{
+			bAnyRegular = true;
+			HighestRegularPriority = FMath::Max(HighestRegularPriority, Rule.Priority);
+		}
+	}
+
+	const int32 KeptPriority = bAnyRegular ? HighestRegularPriority : HighestPriority;
+	Candidates.RemoveAllSwap([&](const FCandidate& Candidate)
+	{
+		return (bAnyRegular && Candidate.bOnlyWhenAlone) || (bKeepOnlyHighestPriority && Candidate.Priority < KeptPriority);
+	}, EAllowShrinking::No);
+
+	// Partial sort, only the boundary of the cap has to be in place
+	if (MaxSelectedUnits > 0 && Candidates.Num() > MaxSelectedUnits)
+	{
+		std::nth_element(
+			Candidates.GetData(),
+			Candidates.GetData() + MaxSelectedUnits,
+			Candidates.GetData() + Candidates.Num(),
+			[](const FCandidate& A, const FCandidate& B) { return A.Priority > B.Priority; }
+		);
+		Candidates.SetNum(MaxSelectedUnits, EAllowShrinking::No);
+	}
+
+	Actors.Reset();
+	for (const FCandidate& Candidate : Candidates)
+	{
+		Actors.Add(Candidate.Actor);
 	}
 }
 
 void URTSSelector::ClearSelectedActors_Implementation()
 {
-	SelectedActors.Empty();
+	if (SelectedActors.Num() == 0)
+	{
+		return;
+	}
+
+	TArray<AActor*> RemovedActors = SelectedActors;
+	while (SelectedActors.Num() > 0)
+	{
+		RemoveSelectedActorAt(SelectedActors.Num() - 1);
+	}
+	DispatchSelectionEvents({}, RemovedActors);
+
+	OnSelectionChanged.Broadcast(TArray<AActor*>(), RemovedActors);
+	NotifySelectionChanged();
+}
+
+FRTSCursorGroundHit URTSSelector::GetCursorGroundHit() const
+{
+	return CameraSubsystem ? CameraSubsystem->GetCursorGroundHit(PlayerController) : FRTSCursorGroundHit();
+}
+
+float URTSSelector::GetAverageBytesPerSelectionChange() const
+{
+	return NumSelectionChanges > 0 ? static_cast<float>(TotalSelectionChangeBytes) / NumSelectionChanges : 0.0f;
+}
+
+bool URTSSelector::CanServerSelect(const AActor* Actor) const
+{
+	if (bAllowSelectingUnownedActors)
+	{
+		return true;
+	}
+
+	/** Without an owning controller nothing is ours, a null instigator must never match it */
+	if (PlayerController == nullptr)
+	{
+		return false;
+	}
+
+	const auto Pawn = PlayerController->GetPawn();
+	const auto Instigator = Actor->GetInstigatorController();
+	return Actor->IsOwnedBy(PlayerController) || (Pawn && Actor->IsOwnedBy(Pawn)) || (Instigator && Instigator == PlayerController);
+}
+
+void URTSSelector::DispatchSelectionEvents(const TConstArrayView<AActor*> Added, const TConstArrayView<AActor*> Removed) const
+{
+	if (Registry)
+	{
+		Registry->DispatchSelectionEvents(Added, Removed);
+		return;
+	}
+
+	for (AActor* Actor : Removed)
+	{
+		IRTSSelection::Execute_OnDeselected(Actor);
+	}
+	for (AActor* Actor : Added)
+	{
+		IRTSSelection::Execute_OnSelected(Actor);
+	}
+}
+
+void URTSSelector::NotifySelectionChanged()
+{
+	if (SelectionRings)
+	{
+		SelectionRings->SetSelectedActors(this, bShowSelectionRings ? SelectedActors : TArray<AActor*>());
+	}
+	ConditionallyReplicateSelection();
+}
+
+void URTSSelector::ConditionallyReplicateSelection()
+{
+	if (!bReplicateSelection || Registry == nullptr || PlayerController == nullptr || !PlayerController->IsLocalController())
+	{
+		return;
+	}
+
+	TBitArray<> SelectionBits(false, Registry->GetNetIdCapacity());
+	for (const AActor* Actor : SelectedActors)
+	{
+		const int32 NetId = Registry->GetNetId(Actor);
+		if (NetId != INDEX_NONE)
+		{
+			SelectionBits[NetId] = true;
+		}
+	}
+
+	if (!FRTSSelectionBitsetCodec::HasDifferences(ReplicatedSelectionBits, SelectionBits))
+	{
+		return;
+	}
+
+	FBitWriter Writer(64 * 8, true);
+	FRTSSelectionBitsetCodec::WriteDelta(Writer, ReplicatedSelectionBits, SelectionBits);
+	CountSelectionChange(Writer.GetNumBytes());
+
+	/** A listen server host is its own server, validate right away */
+	if (GetOwnerRole() == ROLE_Authority)
+	{
+		Registry->UpdateNetIdClaims(ReplicatedSelectionBits, SelectionBits);
+		ReplicatedSelectionBits = MoveTemp(SelectionBits);
+		ValidateReplicatedSelection();
+		return;
+	}
+
+	ReplicatedSelectionBits = MoveTemp(SelectionBits);
+	ServerReceiveSelectionDelta(TArray<uint8>(Writer.GetData(), Writer.GetNumBytes()));
+}
+
+void URTSSelector::ServerReceiveSelectionDelta_Implementation(const TArray<uint8>& Payload)
+{
+	if (Registry == nullptr)
+	{
+		return;
+	}
+
+	FBitReader Reader(const_cast<uint8*>(Payload.GetData()), Payload.Num() * 8);
+	TBitArray<> ClaimedBits = ReplicatedSelectionBits;
+	if (!FRTSSelectionBitsetCodec::ReadDelta(Reader, URTSSelectableRegistry::MaxNetIds, ClaimedBits))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("URTSSelector received a malformed selection delta from %s."), *GetNameSafe(PlayerController));
+		return;
+	}
+
+	Registry->UpdateNetIdClaims(ReplicatedSelectionBits, ClaimedBits);
+	ReplicatedSelectionBits = MoveTemp(ClaimedBits);
+
+	CountSelectionChange(Payload.Num());
+	ValidateReplicatedSelection();
+}
+
+void URTSSelector::ValidateReplicatedSelection()
+{
+	/** One pass over the claimed units, everything that does not resolve or is not ours gets rejected */
+	TBitArray<> Rejected(false, ReplicatedSelectionBits.Num());
+	bool bAnyRejected = false;
+
+	AuthoritativeSelectedActors.Reset();
+	for (TConstSetBitIterator<> It(ReplicatedSelectionBits); It; ++It)
+	{
+		AActor* Actor = Registry->FindByNetId(It.GetIndex());
+		if (Actor && CanServerSelect(Actor))
+		{
+			AuthoritativeSelectedActors.Add(Actor);
+		}
+		else
+		{
+			Rejected[It.GetIndex()] = true;
+			bAnyRejected = true;
+		}
+	}
+
+	OnAuthoritativeSelectionChanged.Broadcast(AuthoritativeSelectedActors);
+
+	/** The claimed bits stay as they are so the next delta still applies, the client drops the rejected units itself */
+	if (bAnyRejected)
+	{
+		if (PlayerController && PlayerController->IsLocalController())
+		{
+			DeselectRejected(Rejected);
+		}
+		else
+		{
+			FBitWriter Writer(64 * 8, true);
+			FRTSSelectionBitsetCodec::WriteRuns(Writer, Rejected);
+			ClientRejectSelection(TArray<uint8>(Writer.GetData(), Writer.GetNumBytes()));
+		}
+	}
+}
+
+void URTSSelector::ClientRejectSelection_Implementation(const TArray<uint8>& Payload)
+{
+	FBitReader Reader(const_cast<uint8*>(Payload.GetData()), Payload.Num() * 8);
+	TBitArray<> Rejected;
+	if (Registry && FRTSSelectionBitsetCodec::ReadRuns(Reader, URTSSelectableRegistry::MaxNetIds, Rejected))
+	{
+		DeselectRejected(Rejected);
+	}
+}
+
+void URTSSelector::DeselectRejected(const TBitArray<>& Rejected)
+{
+	TArray<AActor*> RemovedActors;
+	for (int32 Index = SelectedActors.Num() - 1; Index >= 0; --Index)
+	{
+		AActor* Actor = SelectedActors[Index];
+		const int32 NetId = Registry->GetNetId(Actor);
+		if (NetId != INDEX_NONE && Rejected.IsValidIndex(NetId) && Rejected[NetId])
+		{
+			RemoveSelectedActorAt(Index);
+			RemovedActors.Add(Actor);
+		}
+	}
+
+	if (RemovedActors.Num() > 0)
+	{
+		DispatchSelectionEvents({}, RemovedActors);
+		OnSelectionChanged.Broadcast(TArray<AActor*>(), RemovedActors);
+		NotifySelectionChanged();
+	}
+}
+
+void URTSSelector::CountSelectionChange(const int32 NumBytes)
+{
+	LastSelectionChangeBytes = NumBytes;
+	TotalSelectionChangeBytes += NumBytes;
+	++NumSelectionChanges;
+	INC_DWORD_STAT_BY(STAT_RTSSelectionReplicationBytes, NumBytes);
 }
 
 void URTSSelector::CollectComponentDependencyReferences()
 {
-	if (const auto PlayerControllerRef = UGameplayStatics::GetPlayerController(GetWorld(), 0))
+	/** The selector lives on the player controller, only fall back to the first local player when it was added elsewhere */
+	auto PlayerControllerRef = Cast<APlayerController>(GetOwner());
+	if (PlayerControllerRef == nullptr)
+	{
+		PlayerControllerRef = UGameplayStatics::GetPlayerController(GetWorld(), 0);
+	}
+
+	if (PlayerControllerRef)
 	{
 		PlayerController = PlayerControllerRef;
 		HUD = Cast<ARTSHUD>(PlayerControllerRef->GetHUD());
@@ -95,8 +541,8 @@ void URTSSelector::SetupPlayerInputComponent(UInputComponent* PlayerInputCompone
 {
 	if (const auto InputComponent = Cast<UEnhancedInputComponent>(PlayerInputComponent))
 	{
-		InputComponent->BindAction(BeginSelection, ETriggerEvent::Started, this, &URTSSelector::OnSelectionStart);
-		InputComponent->BindAction(BeginSelection, ETriggerEvent::Completed, this, &URTSSelector::OnSelectionEnd);
+		InputComponent->BindAction(BeginSelection.Get(), ETriggerEvent::Started, this, &URTSSelector::OnSelectionStart);
+		InputComponent->BindAction(BeginSelection.Get(), ETriggerEvent::Completed, this, &URTSSelector::OnSelectionEnd);
 	}
 }
 
@@ -105,21 +551,21 @@ void URTSSelector::BindInputActions()
 	if (const auto EnhancedInputComponent = Cast<UEnhancedInputComponent>(PlayerController->InputComponent))
 	{
 		EnhancedInputComponent->BindAction(
-			BeginSelection,
+			BeginSelection.Get(),
 			ETriggerEvent::Started,
 			this,
 			&URTSSelector::OnSelectionStart
 		);
 
 		EnhancedInputComponent->BindAction(
-			BeginSelection,
+			BeginSelection.Get(),
 			ETriggerEvent::Triggered,
 			this,
 			&URTSSelector::OnUpdateSelection
 		);
 
 		EnhancedInputComponent->BindAction(
-			BeginSelection,
+			BeginSelection.Get(),
 			ETriggerEvent::Completed,
 			this,
 			&URTSSelector::OnSelectionEnd
@@ -127,6 +573,52 @@ void URTSSelector::BindInputActions()
 	}
 }
 
+void URTSSelector::RequestInputAssets()
+{
+	if (InputAssetsHandle && InputAssetsHandle->IsLoadingInProgress())
+	{
+		return;
+	}
+
+	TArray<FSoftObjectPath> Pending;
+	for (const FSoftObjectPath& Path : {InputMappingContext.ToSoftObjectPath(), BeginSelection.ToSoftObjectPath()})
+	{
+		if (!Path.IsNull() && Path.ResolveObject() == nullptr)
+		{
+			Pending.Add(Path);
+		}
+	}
+
+	if (Pending.Num() == 0)
+	{
+		OnInputAssetsLoaded();
+		return;
+	}
+
+	InputAssetsRequestTime = FPlatformTime::Seconds();
+	InputAssetsHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(
+		MoveTemp(Pending), FStreamableDelegate::CreateUObject(this, &URTSSelector::OnInputAssetsLoaded));
+}
+
+void URTSSelector::OnInputAssetsLoaded()
+{
+	if (InputAssetsHandle)
+	{
+		UE_LOG(LogTemp, Verbose, TEXT("URTSSelector: input assets streamed in %.2f ms"),
+		       (FPlatformTime::Seconds() - InputAssetsRequestTime) * 1000.0);
+		InputAssetsHandle.Reset();
+	}
+
+	LoadedInputAssets = {InputMappingContext.Get(), BeginSelection.Get()};
+	LoadedInputAssets.Remove(nullptr);
+
+	if (PlayerController)
+	{
+		BindInputMappingContext();
+		BindInputActions();
+	}
+}
+
 void URTSSelector::BindInputMappingContext() const
 {
 	if (PlayerController && PlayerController->GetLocalPlayer())
@@ -136,10 +628,10 @@ void URTSSelector::BindInputMappingContext() const
 			PlayerController->bShowMouseCursor = true;
 
 			// Check if the context is already bound to prevent double binding
-			if (!Input->HasMappingContext(InputMappingContext))
+			if (!Input->HasMappingContext(InputMappingContext.Get()))
 			{
 				Input->ClearAllMappings();
-				Input->AddMappingContext(InputMappingContext, 0);
+				Input->AddMappingContext(InputMappingContext.Get(), 0);
 			}
 		}
 	}
@@ -149,6 +641,8 @@ void URTSSelector::OnSelectionStart(const FInputActionValue& Value)
 {
 	FVector2D MousePosition;
 	PlayerController->GetMousePosition(MousePosition.X, MousePosition.Y);
+	SelectionStart = MousePosition;
+	SelectionEnd = MousePosition;
 	HUD->BeginSelection(MousePosition);
 }
 
@@ -162,6 +656,385 @@ void URTSSelector::OnUpdateSelection(const FInputActionValue& Value)
 
 void URTSSelector::OnSelectionEnd(const FInputActionValue& Value)
 {
+	FVector2D MousePosition;
+	PlayerController->GetMousePosition(MousePosition.X, MousePosition.Y);
+
+	// A release right where we pressed is a click, resolve it against the registry instead of a box query. Games that
+	// do not register their units keep going through PerformSelection, the registry would not find anything to click
+	if (bEnableClickSelection && CanBoxSelectFromRegistry() && FVector2D::Distance(SelectionStart, MousePosition) <= ClickDragThreshold)
+	{
+		HUD->CancelSelection();
+
+		const double Now = GetWorld()->GetRealTimeSeconds();
+		const auto Picked = PickSelectableAt(MousePosition);
+		const bool bDoubleClick = Picked && Picked == LastClickedActor && Now - LastClickTime <= DoubleClickTime;
+		SelectPickedAtScreenPosition(MousePosition, Picked, bDoubleClick);
+
+		LastClickedActor = bDoubleClick ? nullptr : Picked;
+		LastClickTime = Now;
+		return;
+	}
+
 	// Call PerformSelection on the HUD to execute selection logic
 	HUD->EndSelection();
 }
+
+bool URTSSelector::IsClusteringActive() const
+{
+	if (!bEnableClustering || PlayerController == nullptr || PlayerController->GetPawn() == nullptr)
+	{
+		return false;
+	}
+
+	const auto Camera = PlayerController->GetPawn()->FindComponentByClass<URTSCamera>();
+	return Camera && Camera->GetZoomLength() > ClusterZoomLength;
+}
+
+const FRTSScreenClusterGrid* URTSSelector::UpdateUnitClusters()
+{
+	if (UnitClusters.BuildFrame != GFrameCounter)
+	{
+		FRTSScreenProjector Projector;
+		if (Registry == nullptr || !Projector.Initialize(PlayerController))
+		{
+			return nullptr;
+		}
+
+		Registry->SyncTransforms();
+		UnitClusters.Build(Projector, Registry->GetLocations(), ClusterCellSize, VisibilityGrid.Get());
+		UnitClusters.BuildFrame = GFrameCounter;
+	}
+	return &UnitClusters;
+}
+
+void URTSSelector::SelectClustersInRectangle(const FVector2D& FirstPoint, const FVector2D& SecondPoint)
+{
+	TArray<AActor*> NewSelectedActors;
+	if (const auto Clusters = UpdateUnitClusters())
+	{
+		const FBox2D Rectangle(
+			FVector2D(FMath::Min(FirstPoint.X, SecondPoint.X), FMath::Min(FirstPoint.Y, SecondPoint.Y)),
+			FVector2D(FMath::Max(FirstPoint.X, SecondPoint.X), FMath::Max(FirstPoint.Y, SecondPoint.Y))
+		);
+
+		for (int32 Cluster = 0; Cluster < Clusters->GetClusters().Num(); ++Cluster)
+		{
+			if (Rectangle.IsInside(Clusters->GetClusters()[Cluster].ScreenCenter))
+			{
+				for (const int32 Slot : Clusters->GetMembers(Cluster))
+				{
+					NewSelectedActors.Add(Registry->GetActor(Slot));
+				}
+			}
+		}
+	}
+
+	HandleSelectedActors(NewSelectedActors);
+}
+
+TArray<FRTSScreenCluster> URTSSelector::GetSelectedClusters()
+{
+	FRTSScreenProjector Projector;
+	if (!Projector.Initialize(PlayerController))
+	{
+		return TArray<FRTSScreenCluster>();
+	}
+
+	TArray<FVector> Locations;
+	Locations.Reserve(SelectedActors.Num());
+	for (const AActor* Actor : SelectedActors)
+	{
+		if (IsValid(Actor))
+		{
+			Locations.Add(Actor->GetActorLocation());
+		}
+	}
+
+	SelectedClusters.Build(Projector, Locations, ClusterCellSize);
+	return SelectedClusters.GetClusters();
+}
+
+void URTSSelector::SetVisibilityGrid(const TSharedPtr<const FRTSVisibilityGrid> InVisibilityGrid)
+{
+	VisibilityGrid = InVisibilityGrid;
+	UnitClusters.BuildFrame = MAX_uint64;
+}
+
+bool URTSSelector::CanBoxSelectFromRegistry() const
+{
+	// Registered units are the only ones with a known fog cell, an empty registry means the game does not use it
+	return Registry && (VisibilityGrid.IsValid() || (bBoxSelectFromRegistry && Registry->GetNumSelectables() > 0));
+}
+
+bool URTSSelector::GatherSelectableSlotsInRectangle(const FVector2D& FirstPoint, const FVector2D& SecondPoint, FRTSScreenProjector& OutProjector, TArray<int32>& OutSlots) const
+{
+	OutSlots.Reset();
+	FRTSSelectionFrustum Frustum;
+	if (Registry == nullptr || !OutProjector.Initialize(PlayerController) || !Frustum.Build(OutProjector, FirstPoint, SecondPoint))
+	{
+		return false;
+	}
+
+	Registry->SyncTransforms();
+	Frustum.Classify(Registry->GetLocations(), Registry->GetBoundsRadii(), BoxSelectionTest, OutSlots, VisibilityGrid.Get());
+	return true;
+}
+
+void URTSSelector::SelectSelectablesInRectangle(const FVector2D& FirstPoint, const FVector2D& SecondPoint)
+{
+	TArray<AActor*> NewSelectedActors;
+	FRTSScreenProjector Projector;
+	TArray<int32> Slots;
+	if (GatherSelectableSlotsInRectangle(FirstPoint, SecondPoint, Projector, Slots))
+	{
+		NewSelectedActors.Reserve(Slots.Num());
+		for (const int32 Slot : Slots)
+		{
+			NewSelectedActors.Add(Registry->GetActor(Slot));
+		}
+	}
+
+	HandleSelectedActors(NewSelectedActors);
+}
+
+void URTSSelector::GetSelectableScreenBoundsInRectangle(const FVector2D& FirstPoint, const FVector2D& SecondPoint, TArray<FBox2D>& OutScreenBounds) const
+{
+	OutScreenBounds.Reset();
+	FRTSScreenProjector Projector;
+	TArray<int32> Slots;
+	if (!GatherSelectableSlotsInRectangle(FirstPoint, SecondPoint, Projector, Slots))
+	{
+		return;
+	}
+
+	// Only the units that made it through the planes get projected
+	const TArray<FVector>& Locations = Registry->GetLocations();
+	const TArray<float>& BoundsRadii = Registry->GetBoundsRadii();
+	for (const int32 Slot : Slots)
+	{
+		FVector2D UnitScreenPosition;
+		double Depth;
+		if (Projector.Project(Locations[Slot], UnitScreenPosition, Depth))
+		{
+			const FVector2D Extent(Projector.ProjectRadius(BoundsRadii[Slot], Depth));
+			OutScreenBounds.Emplace(UnitScreenPosition - Extent, UnitScreenPosition + Extent);
+		}
+	}
+}
+
+AActor* URTSSelector::PickSelectableAt(const FVector2D& ScreenPosition) const
+{
+	FRTSScreenProjector Projector;
+	if (Registry == nullptr || !Projector.Initialize(PlayerController))
+	{
+		return nullptr;
+	}
+
+	Registry->SyncTransforms();
+	const TArray<FVector>& Locations = Registry->GetLocations();
+	const TArray<float>& BoundsRadii = Registry->GetBoundsRadii();
+
+	// Among all the units whose projected bounds contain the point, the one closest to the camera wins
+	int32 BestSlot = INDEX_NONE;
+	double BestDepth = TNumericLimits<double>::Max();
+	for (int32 Slot = 0; Slot < Locations.Num(); ++Slot)
+	{
+		FVector2D UnitScreenPosition;
+		double Depth;
+		if (!IsLocationVisible(Locations[Slot]) || !Projector.Project(Locations[Slot], UnitScreenPosition, Depth) || Depth >= BestDepth)
+		{
+			continue;
+		}
+
+		const float PickRadius = Projector.ProjectRadius(BoundsRadii[Slot], Depth) + ClickTolerance;
+		if (FVector2D::DistSquared(UnitScreenPosition, ScreenPosition) <= FMath::Square(PickRadius))
+		{
+			BestSlot = Slot;
+			BestDepth = Depth;
+		}
+	}
+
+	return BestSlot != INDEX_NONE ? Registry->GetActor(BestSlot) : nullptr;
+}
+
+void URTSSelector::SelectAtScreenPosition(const FVector2D& ScreenPosition, const bool bSelectAllOfClassOnScreen)
+{
+	SelectPickedAtScreenPosition(ScreenPosition, PickSelectableAt(ScreenPosition), bSelectAllOfClassOnScreen);
+}
+
+void URTSSelector::SelectPickedAtScreenPosition(const FVector2D& ScreenPosition, AActor* Picked, const bool bSelectAllOfClassOnScreen)
+{
+	TArray<AActor*> NewSelectedActors;
+	const FRTSScreenClusterGrid* Clusters = IsClusteringActive() ? UpdateUnitClusters() : nullptr;
+	const int32 PickedCluster = Clusters ? Clusters->FindClusterAt(ScreenPosition) : INDEX_NONE;
+	if (PickedCluster != INDEX_NONE && !bSelectAllOfClassOnScreen)
+	{
+		// Zoomed out, a click takes the whole cluster under the cursor
+		for (const int32 Slot : Clusters->GetMembers(PickedCluster))
+		{
+			NewSelectedActors.Add(Registry->GetActor(Slot));
+		}
+	}
+	else if (Picked)
+	{
+		if (bSelectAllOfClassOnScreen)
+		{
+			GatherOnScreenSelectablesOfClass(Registry->GetClassId(Registry->FindSlot(Picked)), NewSelectedActors);
+		}
+		else
+		{
+			NewSelectedActors.Add(Picked);
+		}
+	}
+
+	HandleSelectedActors(NewSelectedActors);
+
+	// Entities have no pickable bounds of their own here, treat the click as a tiny box around the cursor
+	if (Registry && Registry->GetEntitySources().Num() > 0)
+	{
+		SelectEntitiesInRectangle(ScreenPosition - FVector2D(ClickTolerance), ScreenPosition + FVector2D(ClickTolerance));
+	}
+}
+
+void URTSSelector::SelectEntitiesInRectangle(const FVector2D& FirstPoint, const FVector2D& SecondPoint)
+{
+	SCOPE_CYCLE_COUNTER(STAT_RTSEntitySelectionQuery);
+
+	FRTSScreenProjector Projector;
+	if (Registry == nullptr || (Registry->GetEntitySources().Num() == 0 && SelectedEntities.Num() == 0) || !Projector.Initialize(PlayerController))
+	{
+		return;
+	}
+
+	const FVector2D Min(FMath::Min(FirstPoint.X, SecondPoint.X), FMath::Min(FirstPoint.Y, SecondPoint.Y));
+	const FVector2D Max(FMath::Max(FirstPoint.X, SecondPoint.X), FMath::Max(FirstPoint.Y, SecondPoint.Y));
+
+	TArray<FRTSEntityHandle> NewSelectedEntities;
+	const TArray<URTSEntitySelectionSource*>& Sources = Registry->GetEntitySources();
+	for (int32 SourceId = 0; SourceId < Sources.Num(); ++SourceId)
+	{
+		const auto Source = Sources[SourceId];
+		if (Source == nullptr)
+		{
+			continue;
+		}
+
+		EntityCandidates.Reset();
+		Source->GatherCandidates(EntityCandidates);
+
+		// Project in chunks on the task graph, each chunk collects its hits so the result keeps the source order
+		constexpr int32 ChunkSize = 4096;
+		const TArray<FVector>& Locations = EntityCandidates.Locations;
+		const TArray<float>& BoundsRadii = EntityCandidates.BoundsRadii;
+		const int32 NumChunks = FMath::DivideAndRoundUp(Locations.Num(), ChunkSize);
+		TArray<TArray<int32>> ChunkHits;
+		ChunkHits.SetNum(NumChunks);
+
+		ParallelFor(NumChunks, [&](const int32 Chunk)
+		{
+			const int32 End = FMath::Min((Chunk + 1) * ChunkSize, Locations.Num());
+			for (int32 Candidate = Chunk * ChunkSize; Candidate < End; ++Candidate)
+			{
+				FVector2D ScreenPosition;
+				double Depth;
+				if (!IsLocationVisible(Locations[Candidate]) || !Projector.Project(Locations[Candidate], ScreenPosition, Depth))
+				{
+					continue;
+				}
+
+				// Hit when the projected bounds overlap the rectangle, like PickSelectableAt
+				const float Radius = Projector.ProjectRadius(BoundsRadii[Candidate], Depth);
+				if (ScreenPosition.X + Radius >= Min.X && ScreenPosition.X - Radius <= Max.X
+					&& ScreenPosition.Y + Radius >= Min.Y && ScreenPosition.Y - Radius <= Max.Y)
+				{
+					ChunkHits[Chunk].Add(Candidate);
+				}
+			}
+		});
+
+		const int32 Generation = Source->GetGeneration();
+		for (const TArray<int32>& Hits : ChunkHits)
+		{
+			for (const int32 Candidate : Hits)
+			{
+				NewSelectedEntities.Add({SourceId, EntityCandidates.Indices[Candidate], Generation});
+			}
+		}
+	}
+
+	HandleSelectedEntities(NewSelectedEntities);
+}
+
+void URTSSelector::HandleSelectedEntities(const TArray<FRTSEntityHandle>& NewSelectedEntities)
+{
+	TArray<FRTSEntityHandle> Sorted = NewSelectedEntities;
+	Sorted.Sort();
+
+	// Both selections are sorted, one merge pass finds what was added and what was removed
+	TArray<FRTSEntityHandle> Selected;
+	TArray<FRTSEntityHandle> Deselected;
+	int32 Old = 0;
+	int32 New = 0;
+	while (Old < SelectedEntities.Num() || New < Sorted.Num())
+	{
+		if (New == Sorted.Num() || (Old < SelectedEntities.Num() && SelectedEntities[Old] < Sorted[New]))
+		{
+			Deselected.Add(SelectedEntities[Old++]);
+		}
+		else if (Old == SelectedEntities.Num() || Sorted[New] < SelectedEntities[Old])
+		{
+			Selected.Add(Sorted[New++]);
+		}
+		else
+		{
+			// Same entity, a reused index has another serial and went through the branches above
+			++Old;
+			++New;
+		}
+	}
+
+	if (Selected.Num() == 0 && Deselected.Num() == 0)
+	{
+		return;
+	}
+
+	// Notify each source once with its own slice of the changes
+	const int32 NumSources = Registry ? Registry->GetEntitySources().Num() : 0;
+	for (int32 SourceId = 0; SourceId < NumSources; ++SourceId)
+	{
+		if (const auto Source = Registry->GetEntitySources()[SourceId])
+		{
+			const auto InSource = [SourceId](const FRTSEntityHandle& Handle) { return Handle.SourceId == SourceId; };
+			const TArray<FRTSEntityHandle> SourceSelected = Selected.FilterByPredicate(InSource);
+			const TArray<FRTSEntityHandle> SourceDeselected = Deselected.FilterByPredicate(InSource);
+			if (SourceSelected.Num() > 0 || SourceDeselected.Num() > 0)
+			{
+				Source->OnEntitySelectionChanged(SourceSelected, SourceDeselected);
+			}
+		}
+	}
+
+	SelectedEntities = MoveTemp(Sorted);
+	OnEntitiesSelected.Broadcast(SelectedEntities);
+}
+
+void URTSSelector::GatherOnScreenSelectablesOfClass(const int32 ClassId, TArray<AActor*>& OutActors) const
+{
+	FRTSScreenProjector Projector;
+	if (!Projector.Initialize(PlayerController))
+	{
+		return;
+	}
+
+	// Only the units of the class are visited, their positions were refreshed by the pick that got us here
+	const TArray<FVector>& Locations = Registry->GetLocations();
+	for (const int32 Slot : Registry->GetSlotsOfClass(ClassId))
+	{
+		FVector2D UnitScreenPosition;
+		double Depth;
+		if (IsLocationVisible(Locations[Slot]) && Projector.Project(Locations[Slot], UnitScreenPosition, Depth) && Projector.IsOnScreen(UnitScreenPosition))
+		{
+			OutActors.Add(Registry->GetActor(Slot));
+		}
+	}
+}
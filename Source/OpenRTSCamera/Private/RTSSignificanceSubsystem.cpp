@@ -0,0 +1,203 @@
+// Copyright 2024 Jesus Bracho All Rights Reserved.
+
+#include "RTSSignificanceSubsystem.h"
+
+#include "RTSCameraStats.h"
+#include "RTSSelectableRegistry.h"
+#include "Components/SkinnedMeshComponent.h"
+#include "Components/WidgetComponent.h"
+#include "Particles/ParticleSystemComponent.h"
+
+DECLARE_CYCLE_STAT(TEXT("Significance Update"), STAT_RTSSignificanceUpdate, STATGROUP_OpenRTSCamera);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Significance Bucket Changes"), STAT_RTSSignificanceChanges, STATGROUP_OpenRTSCamera);
+
+void URTSSignificanceSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+	Registry = Collection.InitializeDependency<URTSSelectableRegistry>();
+	UnregisteredHandle = Registry->OnSelectableUnregistered.AddUObject(this, &URTSSignificanceSubsystem::HandleSelectableUnregistered);
+}
+
+void URTSSignificanceSubsystem::Deinitialize()
+{
+	if (Registry)
+	{
+		Registry->OnSelectableUnregistered.Remove(UnregisteredHandle);
+	}
+	Super::Deinitialize();
+}
+
+void URTSSignificanceSubsystem::Tick(const float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+	if (Viewpoints.Num() > 0)
+	{
+		UpdateSignificance(UpdateBudget);
+		Viewpoints.Reset();
+	}
+}
+
+TStatId URTSSignificanceSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(URTSSignificanceSubsystem, STATGROUP_OpenRTSCamera);
+}
+
+void URTSSignificanceSubsystem::ReportViewpoint(const FRTSSignificanceViewpoint& Viewpoint)
+{
+	Viewpoints.Add(Viewpoint);
+}
+
+bool URTSSignificanceSubsystem::Configure(
+	const TArray<FRTSSignificanceBucketSettings>& InBuckets,
+	const float InZoomedOutLength,
+	const int32 InUpdateBudget
+)
+{
+	/** The significance column stores buckets as bytes with MAX_uint8 reserved as "unassigned" */
+	TArray<FRTSSignificanceBucketSettings> NewBuckets = InBuckets;
+	NewBuckets.SetNum(FMath::Min(NewBuckets.Num(), static_cast<int32>(URTSSelectableRegistry::UnassignedSignificance)));
+	const int32 NewUpdateBudget = FMath::Max(1, InUpdateBudget);
+
+	if (bConfigured)
+	{
+		const bool bSame = NewBuckets == Buckets && InZoomedOutLength == ZoomedOutLength && NewUpdateBudget == UpdateBudget;
+		if (!bSame)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("URTSSignificanceSubsystem is already configured for this world, ignoring other settings."));
+		}
+		return bSame;
+	}
+
+	bConfigured = true;
+	Buckets = MoveTemp(NewBuckets);
+	ZoomedOutLength = InZoomedOutLength;
+	UpdateBudget = NewUpdateBudget;
+
+	/** Bucket layout changed, every unit has to be re-evaluated */
+	BucketCounts.Init(0, Buckets.Num());
+	for (uint8& Bucket : Registry->GetSignificance())
+	{
+		Bucket = URTSSelectableRegistry::UnassignedSignificance;
+	}
+	return true;
+}
+
+int32 URTSSignificanceSubsystem::UpdateSignificance(const int32 Budget)
+{
+	SCOPE_CYCLE_COUNTER(STAT_RTSSignificanceUpdate);
+
+	const int32 NumSelectables = Registry->GetNumSelectables();
+	if (Buckets.Num() == 0 || NumSelectables == 0)
+	{
+		return 0;
+	}
+
+	TArray<uint8>& Significance = Registry->GetSignificance();
+	const TArray<FVector>& Locations = Registry->GetLocations();
+	const int32 NumToVisit = FMath::Min(Budget, NumSelectables);
+
+	PendingChanges.Reset();
+	for (int32 Visited = 0; Visited < NumToVisit; ++Visited)
+	{
+		/** The registry synced the locations of the units that moved earlier in the frame */
+		Cursor = Cursor < NumSelectables ? Cursor : 0;
+
+		const uint8 Bucket = static_cast<uint8>(ComputeBucket(Locations[Cursor]));
+		if (Bucket != Significance[Cursor])
+		{
+			PendingChanges.Emplace(Cursor, Bucket);
+		}
+		++Cursor;
+	}
+
+	/** Group the changes per bucket so the settings of one bucket are applied back to back */
+	PendingChanges.Sort([](const TPair<int32, uint8>& A, const TPair<int32, uint8>& B) { return A.Value < B.Value; });
+	for (const auto& [Slot, Bucket] : PendingChanges)
+	{
+		const uint8 Previous = Significance[Slot];
+		if (Previous != URTSSelectableRegistry::UnassignedSignificance)
+		{
+			--BucketCounts[Previous];
+		}
+		++BucketCounts[Bucket];
+		Significance[Slot] = Bucket;
+
+		if (const auto Actor = Registry->GetActor(Slot))
+		{
+			ApplyBucket(Actor, Bucket);
+		}
+	}
+
+	INC_DWORD_STAT_BY(STAT_RTSSignificanceChanges, PendingChanges.Num());
+	return PendingChanges.Num();
+}
+
+int32 URTSSignificanceSubsystem::GetNumUnitsInBucket(const int32 Bucket) const
+{
+	return BucketCounts.IsValidIndex(Bucket) ? BucketCounts[Bucket] : 0;
+}
+
+int32 URTSSignificanceSubsystem::ComputeBucket(const FVector& Location) const
+{
+	/** Closest footprint wins, that camera's zoom decides whether the unit gets pushed down a bucket */
+	float Distance = MAX_flt;
+	float ZoomLength = 0;
+	for (const auto& Viewpoint : Viewpoints)
+	{
+		const float DistanceToFootprint = FMath::Max(0.0f, static_cast<float>(FVector::Dist2D(Location, Viewpoint.FootprintCenter)) - Viewpoint.FootprintRadius);
+		if (DistanceToFootprint < Distance)
+		{
+			Distance = DistanceToFootprint;
+			ZoomLength = Viewpoint.ZoomLength;
+		}
+	}
+
+	const int32 LastBucket = Buckets.Num() - 1;
+	int32 Bucket = LastBucket;
+	for (int32 Index = 0; Index < LastBucket; ++Index)
+	{
+		if (Distance <= Buckets[Index].MaxDistance)
+		{
+			Bucket = Index;
+			break;
+		}
+	}
+
+	if (ZoomedOutLength > 0 && ZoomLength >= ZoomedOutLength)
+	{
+		Bucket = FMath::Min(Bucket + 1, LastBucket);
+	}
+
+	return Bucket;
+}
+
+void URTSSignificanceSubsystem::ApplyBucket(AActor* Actor, const int32 Bucket) const
+{
+	const auto& Settings = Buckets[Bucket];
+	Actor->SetActorTickInterval(Settings.ActorTickInterval);
+
+	for (UActorComponent* Component : Actor->GetComponents())
+	{
+		if (const auto Widget = Cast<UWidgetComponent>(Component))
+		{
+			Widget->SetVisibility(Settings.bShowWidgets);
+		}
+		else if (Cast<USkinnedMeshComponent>(Component))
+		{
+			Component->SetComponentTickInterval(Settings.AnimationTickInterval);
+		}
+		else if (Cast<UFXSystemComponent>(Component))
+		{
+			Component->SetComponentTickInterval(Settings.EffectsTickInterval);
+		}
+	}
+}
+
+void URTSSignificanceSubsystem::HandleSelectableUnregistered(AActor* Actor, const int32 Slot)
+{
+	const uint8 Bucket = Registry->GetSignificance()[Slot];
+	if (BucketCounts.IsValidIndex(Bucket))
+	{
+		--BucketCounts[Bucket];
+	}
+}
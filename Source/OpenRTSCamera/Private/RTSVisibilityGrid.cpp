@@ -0,0 +1,50 @@
+// Copyright 2024 Jesus Bracho All Rights Reserved.
+
+#include "RTSVisibilityGrid.h"
+
+void FRTSVisibilityGrid::Initialize(const FVector2D& InOrigin, const float InCellSize, const int32 InWidth, const int32 InHeight)
+{
+	Origin = InOrigin;
+	CellSize = FMath::Max(InCellSize, 1.0f);
+	Width = FMath::Max(InWidth, 0);
+	Height = FMath::Max(InHeight, 0);
+	Words.SetNumZeroed(static_cast<int32>(FMath::DivideAndRoundUp<int64>(static_cast<int64>(Width) * Height, 64)));
+}
+
+void FRTSVisibilityGrid::SetCellVisible(const int32 X, const int32 Y, const bool bVisible)
+{
+	if (X < 0 || X >= Width || Y < 0 || Y >= Height)
+	{
+		return;
+	}
+
+	const int64 Bit = static_cast<int64>(Y) * Width + X;
+	const uint64 Mask = uint64(1) << (Bit & 63);
+	if (bVisible)
+	{
+		Words[static_cast<int32>(Bit >> 6)] |= Mask;
+	}
+	else
+	{
+		Words[static_cast<int32>(Bit >> 6)] &= ~Mask;
+	}
+}
+
+void FRTSVisibilityGrid::SetAllVisible(const bool bVisible)
+{
+	for (uint64& Word : Words)
+	{
+		Word = bVisible ? MAX_uint64 : 0;
+	}
+}
+
+bool FRTSVisibilityGrid::SetWords(const TConstArrayView<uint64> InWords)
+{
+	if (InWords.Num() != Words.Num())
+	{
+		return false;
+	}
+
+	FMemory::Memcpy(Words.GetData(), InWords.GetData(), InWords.Num() * sizeof(uint64));
+	return true;
+}
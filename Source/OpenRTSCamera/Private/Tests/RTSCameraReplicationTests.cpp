@@ -0,0 +1,245 @@
+// Copyright 2024 Jesus Bracho All Rights Reserved.
+
+#include "RTSCameraReplicator.h"
+#include "RTSNetworkTestSession.h"
+#include "Misc/AutomationTest.h"
+#include "Serialization/BitReader.h"
+#include "Serialization/BitWriter.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#if WITH_EDITOR
+#include "EngineUtils.h"
+#include "GameFramework/SpringArmComponent.h"
+#endif
+
+namespace RTSCameraReplicationTests
+{
+	FRTSCameraViewState MakeState(const FVector& Location, const float Yaw, const float Pitch, const float Zoom)
+	{
+		FRTSCameraViewState State;
+		State.Location = Location;
+		State.Yaw = Yaw;
+		State.Pitch = Pitch;
+		State.Zoom = Zoom;
+		return State;
+	}
+
+	bool RoundTripDelta(const FRTSQuantizedCameraState& Baseline, const FRTSQuantizedCameraState& State, FRTSQuantizedCameraState& OutState, int64& OutNumBits)
+	{
+		FBitWriter Writer(0, true);
+		FRTSCameraStateCodec::WriteDelta(Writer, Baseline, State);
+		OutNumBits = Writer.GetNumBits();
+
+		FBitReader Reader(Writer.GetData(), Writer.GetNumBits());
+		return FRTSCameraStateCodec::ReadDelta(Reader, Baseline, OutState);
+	}
+
+#if WITH_EDITOR
+	/** A rig as driven by its owner and the copy the other side of the connection sees */
+	struct FRigPair
+	{
+		TWeakObjectPtr<ARTSNetworkTestRig> Owned;
+		TWeakObjectPtr<ARTSNetworkTestRig> Remote;
+	};
+
+	struct FListenServerState
+	{
+		/** Owned in the client world, remote in the server world */
+		FRigPair ClientRig;
+
+		/** Owned in the server world, remote in the client world */
+		FRigPair HostRig;
+	};
+
+	constexpr double MoveSeconds = 2.5;
+	constexpr int32 PacketLossPercentage = 10;
+
+	/** A steady pan with a turn through 180 and a slow zoom, each side starts somewhere else */
+	FRTSCameraViewState MovingState(const FVector& Start, const double Seconds)
+	{
+		return MakeState(Start + FVector(1500, 500, 0) * Seconds, FRotator::NormalizeAxis(150 + 40 * Seconds), -50 + 4 * Seconds, 2000 + 200 * Seconds);
+	}
+
+	const FVector ClientStart(0, 0, 0);
+	const FVector HostStart(-5000, 2000, 0);
+
+	void DriveRig(ARTSNetworkTestRig* Rig, const FRTSCameraViewState& State)
+	{
+		Rig->SetActorLocationAndRotation(State.Location, FRotator(0, State.Yaw, 0));
+		Rig->SpringArm->SetRelativeRotation(FRotator(State.Pitch, 0, 0));
+		Rig->SpringArm->TargetArmLength = State.Zoom;
+	}
+
+	/** Within one quantization step on every field */
+	bool IsNear(const FRTSCameraViewState& State, const FRTSCameraViewState& Expected)
+	{
+		return State.Location.Equals(Expected.Location, FRTSCameraStateCodec::PositionPrecision)
+			&& FMath::Abs(FRotator::NormalizeAxis(State.Yaw - Expected.Yaw)) <= 360.0f / FRTSCameraStateCodec::YawSteps
+			&& FMath::Abs(State.Pitch - Expected.Pitch) <= 180.0f / (FRTSCameraStateCodec::PitchSteps - 1)
+			&& FMath::Abs(State.Zoom - Expected.Zoom) <= FRTSCameraStateCodec::ZoomPrecision;
+	}
+
+	/** Where the rig itself is, which is what a spectator using it as view target sees */
+	bool IsRigNear(const ARTSNetworkTestRig* Rig, const FRTSCameraViewState& Expected)
+	{
+		FRTSCameraViewState State;
+		State.Location = Rig->GetActorLocation();
+		State.Yaw = Rig->GetActorRotation().Yaw;
+		State.Pitch = Rig->SpringArm->GetRelativeRotation().Pitch;
+		State.Zoom = Rig->SpringArm->TargetArmLength;
+		return IsNear(State, Expected);
+	}
+#endif
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRTSCameraStateQuantizeTest, "OpenRTSCamera.CameraReplication.Quantize",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::ProductFilter)
+
+bool FRTSCameraStateQuantizeTest::RunTest(const FString& Parameters)
+{
+	using namespace RTSCameraReplicationTests;
+
+	const FRTSCameraViewState State = MakeState(FVector(1234.5, -987.6, 321.0), -90.3f, -60.0f, 2345.0f);
+	const FRTSCameraViewState Decoded = FRTSCameraStateCodec::Dequantize(FRTSCameraStateCodec::Quantize(State));
+
+	TestTrue(TEXT("Location within half a step"), Decoded.Location.Equals(State.Location, FRTSCameraStateCodec::PositionPrecision * 0.5f + UE_KINDA_SMALL_NUMBER));
+	TestNearlyEqual(TEXT("Yaw within half a step, wrapped"), FRotator::NormalizeAxis(Decoded.Yaw - State.Yaw), 0.0f, 180.0f / FRTSCameraStateCodec::YawSteps + UE_KINDA_SMALL_NUMBER);
+	TestNearlyEqual(TEXT("Pitch within half a step"), Decoded.Pitch, State.Pitch, 90.0f / (FRTSCameraStateCodec::PitchSteps - 1) + UE_KINDA_SMALL_NUMBER);
+	TestNearlyEqual(TEXT("Zoom within half a step"), Decoded.Zoom, State.Zoom, FRTSCameraStateCodec::ZoomPrecision * 0.5f + UE_KINDA_SMALL_NUMBER);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRTSCameraStateDeltaTest, "OpenRTSCamera.CameraReplication.Delta",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::ProductFilter)
+
+bool FRTSCameraStateDeltaTest::RunTest(const FString& Parameters)
+{
+	using namespace RTSCameraReplicationTests;
+
+	const FRTSQuantizedCameraState Baseline = FRTSCameraStateCodec::Quantize(MakeState(FVector(1000, 2000, 300), 10, -45, 2000));
+	FRTSQuantizedCameraState Decoded;
+	int64 NumBits = 0;
+
+	TestTrue(TEXT("An unchanged state decodes"), RoundTripDelta(Baseline, Baseline, Decoded, NumBits));
+	TestTrue(TEXT("An unchanged state round trips"), Decoded == Baseline);
+	TestEqual(TEXT("An unchanged state is one flag per field"), NumBits, static_cast<int64>(6));
+
+	const FRTSQuantizedCameraState Moved = FRTSCameraStateCodec::Quantize(MakeState(FVector(1250, 1900, 300), 25, -40, 1800));
+	TestTrue(TEXT("A moved state decodes"), RoundTripDelta(Baseline, Moved, Decoded, NumBits));
+	TestTrue(TEXT("A moved state round trips"), Decoded == Moved);
+
+	// Turning across 0 is a small step the short way around, not a full turn back
+	FRTSQuantizedCameraState Before = Baseline;
+	Before.Yaw = FRTSCameraStateCodec::YawSteps - 6;
+	FRTSQuantizedCameraState After = Baseline;
+	After.Yaw = 5;
+	TestTrue(TEXT("A wrapping yaw decodes"), RoundTripDelta(Before, After, Decoded, NumBits));
+	TestTrue(TEXT("A wrapping yaw round trips"), Decoded.Yaw == After.Yaw);
+	TestTrue(TEXT("A wrapping yaw stays small"), NumBits <= 16);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRTSCameraStateNetSerializeTest, "OpenRTSCamera.CameraReplication.NetSerialize",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::ProductFilter)
+
+bool FRTSCameraStateNetSerializeTest::RunTest(const FString& Parameters)
+{
+	using namespace RTSCameraReplicationTests;
+
+	FRTSQuantizedCameraState State = FRTSCameraStateCodec::Quantize(MakeState(FVector(-51234, 70000, -450), 359.9f, 80, 9000));
+	FBitWriter Writer(0, true);
+	bool bSuccess = false;
+	State.NetSerialize(Writer, nullptr, bSuccess);
+	TestTrue(TEXT("Writes"), bSuccess);
+
+	FBitReader Reader(Writer.GetData(), Writer.GetNumBits());
+	FRTSQuantizedCameraState Decoded;
+	Decoded.NetSerialize(Reader, nullptr, bSuccess);
+	TestTrue(TEXT("Reads"), bSuccess);
+	TestTrue(TEXT("Keyframes round trip"), Decoded == State);
+	return true;
+}
+
+
+#if WITH_EDITOR
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRTSCameraReplicationListenServerTest, "OpenRTSCamera.CameraReplication.ListenServer",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FRTSCameraReplicationListenServerTest::RunTest(const FString& Parameters)
+{
+	using namespace RTSCameraReplicationTests;
+	const TSharedRef<RTSNetworkTest::FSession> Session = RTSNetworkTest::StartSession(*this, PacketLossPercentage);
+	const TSharedRef<FListenServerState> State = MakeShared<FListenServerState>();
+
+	RTSNetworkTest::AddStep(*this, Session, TEXT("Find both rigs on both sides"), [Session, State]()
+	{
+		for (TActorIterator<ARTSNetworkTestRig> It(Session->ServerWorld.Get()); It; ++It)
+		{
+			(It->IsLocallyControlled() ? State->HostRig.Owned : State->ClientRig.Remote) = *It;
+		}
+		for (TActorIterator<ARTSNetworkTestRig> It(Session->ClientWorld.Get()); It; ++It)
+		{
+			(It->IsLocallyControlled() ? State->ClientRig.Owned : State->HostRig.Remote) = *It;
+		}
+		return State->ClientRig.Owned.IsValid() && State->ClientRig.Remote.IsValid() && State->HostRig.Owned.IsValid() && State->HostRig.Remote.IsValid();
+	});
+
+	// The client sends unreliable deltas and reliable keyframes, the host publishes its state straight to the replicated property
+	RTSNetworkTest::AddTimedStep(Session, MoveSeconds, [State](const double Elapsed)
+	{
+		if (State->ClientRig.Owned.IsValid() && State->HostRig.Owned.IsValid())
+		{
+			DriveRig(State->ClientRig.Owned.Get(), MovingState(ClientStart, Elapsed));
+			DriveRig(State->HostRig.Owned.Get(), MovingState(HostStart, Elapsed));
+		}
+	});
+
+	RTSNetworkTest::AddStep(*this, Session, TEXT("Report the bytes per second while moving"), [this, State]()
+	{
+		// Both windows of a second lie within the move and sent and received are counted the same way, the slack covers a
+		// keyframe landing in one window but not the other
+		const float ClientSent = State->ClientRig.Owned->Replicator->GetBytesPerSecond();
+		const float ServerReceived = State->ClientRig.Remote->Replicator->GetBytesPerSecond();
+		const float ClientReceived = State->HostRig.Remote->Replicator->GetBytesPerSecond();
+		AddInfo(FString::Printf(TEXT("Moving: the client sends %.0f B/s, the server receives %.0f B/s, the client receives %.0f B/s of the host's camera"),
+		                        ClientSent, ServerReceived, ClientReceived));
+
+		const float Budget = State->ClientRig.Owned->Replicator->MaxSendRate * 16.0f;
+		TestTrue(TEXT("The client sends while moving"), ClientSent > 0);
+		TestTrue(*FString::Printf(TEXT("The client stays within %.0f B/s"), Budget), ClientSent <= Budget);
+		TestTrue(TEXT("The server receives the client's camera"), ServerReceived > 0);
+		TestTrue(TEXT("Lost deltas are not counted by the server"), ServerReceived <= ClientSent * 1.25f + 16.0f);
+		TestTrue(TEXT("The client never gets its own state back (COND_SkipOwner)"), ClientSent <= ServerReceived * 1.75f + 16.0f);
+		TestTrue(TEXT("The client receives the host's camera"), ClientReceived > 0);
+		return true;
+	});
+
+	// Deltas get lost, the keyframe sent once the camera came to rest is what brings both copies onto the final state
+	RTSNetworkTest::AddStep(*this, Session, TEXT("Both remote copies settle on the final state"), [State]()
+	{
+		const FRTSCameraViewState ClientFinal = MovingState(ClientStart, MoveSeconds);
+		const FRTSCameraViewState HostFinal = MovingState(HostStart, MoveSeconds);
+		return IsNear(State->ClientRig.Remote->Replicator->GetViewState(), ClientFinal) && IsRigNear(State->ClientRig.Remote.Get(), ClientFinal)
+			&& IsNear(State->HostRig.Remote->Replicator->GetViewState(), HostFinal) && IsRigNear(State->HostRig.Remote.Get(), HostFinal);
+	});
+
+	// Long enough for the last full window of a second to start after the settle keyframe
+	RTSNetworkTest::AddTimedStep(Session, 3.5, [](double) {});
+
+	RTSNetworkTest::AddStep(*this, Session, TEXT("Nothing is sent at rest"), [this, State]()
+	{
+		TestEqual(TEXT("An owner at rest sends nothing"), State->ClientRig.Owned->Replicator->GetBytesPerSecond(), 0.0f);
+		TestEqual(TEXT("The server receives nothing from an owner at rest"), State->ClientRig.Remote->Replicator->GetBytesPerSecond(), 0.0f);
+		TestTrue(TEXT("The owner's rig is left where its owner put it"), IsRigNear(State->ClientRig.Owned.Get(), MovingState(ClientStart, MoveSeconds)));
+		return true;
+	});
+
+	RTSNetworkTest::EndSession();
+	return true;
+}
+
+#endif
+
+#endif
@@ -0,0 +1,112 @@
+// Copyright 2024 Jesus Bracho All Rights Reserved.
+
+#include "RTSCameraSmoothing.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace RTSCameraSmoothingTests
+{
+	constexpr int32 FrameRates[] = {30, 60, 240};
+	constexpr ERTSCameraSmoothingMode Modes[] = {ERTSCameraSmoothingMode::ExponentialDecay, ERTSCameraSmoothingMode::CriticallyDampedSpring};
+	constexpr float Speed = 4;
+
+	const TCHAR* ModeName(const ERTSCameraSmoothingMode Mode)
+	{
+		return Mode == ERTSCameraSmoothingMode::ExponentialDecay ? TEXT("ExponentialDecay") : TEXT("CriticallyDampedSpring");
+	}
+
+	/** Advances from 0 for one second at a fixed rate, the target at the end of each frame comes from TargetAt */
+	template <typename FTargetAt>
+	float RunOneSecond(const int32 FrameRate, const ERTSCameraSmoothingMode Mode, FTargetAt&& TargetAt)
+	{
+		TRTSSmoothedChannel<float> Channel;
+		float Value = 0;
+		for (int32 Frame = 1; Frame <= FrameRate; ++Frame)
+		{
+			Value = Channel.Advance(Value, TargetAt(static_cast<float>(Frame) / FrameRate), Speed, 1.0f / FrameRate, Mode);
+		}
+		return Value;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRTSCameraSmoothingFixedTargetTest, "OpenRTSCamera.Smoothing.FixedTarget",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::ProductFilter)
+
+bool FRTSCameraSmoothingFixedTargetTest::RunTest(const FString& Parameters)
+{
+	using namespace RTSCameraSmoothingTests;
+
+	for (const ERTSCameraSmoothingMode Mode : Modes)
+	{
+		// Both modes are solved exactly for a fixed target, every frame rate has to land on the closed form
+		const float Expected = Mode == ERTSCameraSmoothingMode::ExponentialDecay
+			                       ? 1000.0f * (1.0f - FMath::Exp(-Speed))
+			                       : 1000.0f * (1.0f - (1.0f + Speed) * FMath::Exp(-Speed));
+		for (const int32 FrameRate : FrameRates)
+		{
+			const float Value = RunOneSecond(FrameRate, Mode, [](float) { return 1000.0f; });
+			TestNearlyEqual(*FString::Printf(TEXT("%s at %d Hz"), ModeName(Mode), FrameRate), Value, Expected, 0.05f);
+		}
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRTSCameraSmoothingMovingTargetTest, "OpenRTSCamera.Smoothing.MovingTarget",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::ProductFilter)
+
+bool FRTSCameraSmoothingMovingTargetTest::RunTest(const FString& Parameters)
+{
+	using namespace RTSCameraSmoothingTests;
+
+	for (const ERTSCameraSmoothingMode Mode : Modes)
+	{
+		// A target sweeping 1000 units in a second trails by about the same amount whatever the frame rate
+		const float Reference = RunOneSecond(240, Mode, [](const float Time) { return 1000.0f * Time; });
+		for (const int32 FrameRate : FrameRates)
+		{
+			const float Value = RunOneSecond(FrameRate, Mode, [](const float Time) { return 1000.0f * Time; });
+			TestNearlyEqual(*FString::Printf(TEXT("%s at %d Hz"), ModeName(Mode), FrameRate), Value, Reference, 20.0f);
+		}
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRTSCameraSmoothingHitchTest, "OpenRTSCamera.Smoothing.Hitch",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::ProductFilter)
+
+bool FRTSCameraSmoothingHitchTest::RunTest(const FString& Parameters)
+{
+	using namespace RTSCameraSmoothingTests;
+
+	for (const ERTSCameraSmoothingMode Mode : Modes)
+	{
+		// A quarter second hitch while the target moves 250 units follows the target like 15 frames at 60 Hz would
+		TRTSSmoothedChannel<float> Hitched;
+		float HitchedValue = Hitched.Advance(0, 0, Speed, 1.0f / 60.0f, Mode);
+		HitchedValue = Hitched.Advance(HitchedValue, 250, Speed, 0.25f, Mode);
+
+		TRTSSmoothedChannel<float> Smooth;
+		float SmoothValue = Smooth.Advance(0, 0, Speed, 1.0f / 60.0f, Mode);
+		for (int32 Frame = 1; Frame <= 15; ++Frame)
+		{
+			SmoothValue = Smooth.Advance(SmoothValue, 250.0f * Frame / 15, Speed, 1.0f / 60.0f, Mode);
+		}
+
+		TestNearlyEqual(*FString::Printf(TEXT("%s after a hitch"), ModeName(Mode)), HitchedValue, SmoothValue, 7.5f);
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRTSCameraSmoothingSnapTest, "OpenRTSCamera.Smoothing.Snap",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::ProductFilter)
+
+bool FRTSCameraSmoothingSnapTest::RunTest(const FString& Parameters)
+{
+	TRTSSmoothedChannel<float> Channel;
+	TestEqual(TEXT("A speed of 0 snaps to the target"), Channel.Advance(0, 500, 0, 1.0f / 60.0f, ERTSCameraSmoothingMode::ExponentialDecay), 500.0f);
+	TestEqual(TEXT("A zero delta time keeps the value"), Channel.Advance(100, 500, 4, 0, ERTSCameraSmoothingMode::ExponentialDecay), 100.0f);
+	return true;
+}
+
+#endif
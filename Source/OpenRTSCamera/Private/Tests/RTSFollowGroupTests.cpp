@@ -0,0 +1,116 @@
+// Copyright 2024 Jesus Bracho All Rights Reserved.
+
+#include "RTSFollowGroup.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace RTSFollowGroupTests
+{
+	/** Members are keyed by address, these only have to be distinct */
+	int32 Keys[16];
+
+	/** Nine units packed around the origin and one straggler far behind them on X */
+	void AddStragglerGroup(FRTSFollowGroup& Group, const float StragglerX)
+	{
+		for (int32 Index = 0; Index < 9; ++Index)
+		{
+			Group.Add(&Keys[Index], FVector((Index % 3 - 1) * 100.0f, (Index / 3 - 1) * 100.0f, 0));
+		}
+		Group.Add(&Keys[9], FVector(StragglerX, 0, 0));
+		Group.Refresh();
+	}
+
+	bool ContainsEveryMember(const FRTSFollowGroup& Group, const TArray<FVector>& Members)
+	{
+		const FVector Centroid = Group.GetCentroid();
+		for (const FVector& Member : Members)
+		{
+			if (FVector::Dist2D(Centroid, Member) > Group.GetExtentRadius() + UE_KINDA_SMALL_NUMBER)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRTSFollowGroupStragglerTest, "OpenRTSCamera.FollowGroup.Straggler",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::ProductFilter)
+
+bool FRTSFollowGroupStragglerTest::RunTest(const FString& Parameters)
+{
+	using namespace RTSFollowGroupTests;
+
+	FRTSFollowGroup Group;
+	AddStragglerGroup(Group, -3000.0f);
+
+	TArray<FVector> Members;
+	for (int32 Index = 0; Index < 9; ++Index)
+	{
+		Members.Add(FVector((Index % 3 - 1) * 100.0f, (Index / 3 - 1) * 100.0f, 0));
+	}
+	Members.Add(FVector(-3000.0f, 0, 0));
+
+	/** The spread of such a group is far less than the distance to the straggler, the extent is not */
+	TestTrue(TEXT("The spread alone would cut the straggler off"), Group.GetSpreadRadius() * 1.5f < FVector::Dist2D(Group.GetCentroid(), Members.Last()));
+	TestTrue(TEXT("The extent contains every member"), ContainsEveryMember(Group, Members));
+
+	/** The straggler catches up, the bounds shrink back once it left the face it defined */
+	Members.Last() = FVector(-150.0f, 0, 0);
+	Group.Move(&Keys[9], Members.Last());
+	Group.Refresh();
+	TestTrue(TEXT("The extent contains every member after the straggler caught up"), ContainsEveryMember(Group, Members));
+	TestTrue(TEXT("The extent shrank with the bounds"), Group.GetExtentRadius() < 300.0f);
+	TestEqual(TEXT("Bounds min X"), Group.GetBounds().Min.X, -150.0);
+
+	/** Leaving drops the member from the bounds as well */
+	Group.Remove(&Keys[9]);
+	Members.Pop();
+	Group.Refresh();
+	TestEqual(TEXT("Bounds min X without the straggler"), Group.GetBounds().Min.X, -100.0);
+	TestTrue(TEXT("The extent contains every remaining member"), ContainsEveryMember(Group, Members));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRTSFollowGroupDriftTest, "OpenRTSCamera.FollowGroup.Drift",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::ProductFilter)
+
+bool FRTSFollowGroupDriftTest::RunTest(const FString& Parameters)
+{
+	using namespace RTSFollowGroupTests;
+
+	/** A tight group far from the origin walking for a long time, where the running sums lose the most to rounding */
+	FRTSFollowGroup Group;
+	const FVector Origin(1.0e6f, -1.0e6f, 0);
+	TArray<FVector> Members;
+	for (int32 Index = 0; Index < 16; ++Index)
+	{
+		Members.Add(Origin + FVector(Index % 4, Index / 4, 0) * 10.0f);
+		Group.Add(&Keys[Index], Members.Last());
+	}
+
+	FRandomStream Random(7);
+	for (int32 Step = 0; Step < 100000; ++Step)
+	{
+		const int32 Index = Random.RandHelper(16);
+		Members[Index] += FVector(Random.FRandRange(-1.0f, 1.0f), Random.FRandRange(-1.0f, 1.0f), 0);
+		Group.Move(&Keys[Index], Members[Index]);
+	}
+	Group.Refresh();
+
+	FRTSFollowGroup Fresh;
+	for (int32 Index = 0; Index < 16; ++Index)
+	{
+		Fresh.Add(&Keys[Index], Members[Index]);
+	}
+	Fresh.Refresh();
+
+	TestTrue(TEXT("Centroid matches a group built from scratch"), Group.GetCentroid().Equals(Fresh.GetCentroid(), 0.01));
+	TestTrue(TEXT("Spread matches a group built from scratch"), FMath::IsNearlyEqual(Group.GetSpreadRadius(), Fresh.GetSpreadRadius(), 0.5f));
+	TestTrue(TEXT("Extent matches a group built from scratch"), FMath::IsNearlyEqual(Group.GetExtentRadius(), Fresh.GetExtentRadius(), 0.01f));
+	TestTrue(TEXT("The extent contains every member"), ContainsEveryMember(Group, Members));
+	return true;
+}
+
+#endif
@@ -0,0 +1,109 @@
+// Copyright 2024 Jesus Bracho All Rights Reserved.
+
+#include "RTSMinimap.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace RTSMinimapTests
+{
+	/** 64 pixels in tiles of 16, a 4 x 4 tile grid over a 2000 x 2000 area */
+	FRTSMinimapRaster MakeRaster(const FRTSMinimapRaster::FStyle& Style = FRTSMinimapRaster::FStyle())
+	{
+		FRTSMinimapRaster Raster;
+		Raster.Initialize(FBox2D(FVector2D(-1000, -1000), FVector2D(1000, 1000)), 0.05f, 64, 16, Style);
+		return Raster;
+	}
+
+	FVector PixelCenterToWorld(const FRTSMinimapRaster& Raster, const FVector2D& Pixel)
+	{
+		return FVector(Raster.PixelToWorld(Pixel), 0);
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRTSMinimapBackgroundTest, "OpenRTSCamera.Minimap.Background",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::ProductFilter)
+
+bool FRTSMinimapBackgroundTest::RunTest(const FString& Parameters)
+{
+	using namespace RTSMinimapTests;
+	const FRTSMinimapRaster::FStyle Style;
+	FRTSMinimapRaster Raster = MakeRaster(Style);
+
+	TestEqual(TEXT("The first rasterization draws every tile"), Raster.Rasterize({}, {}, FRTSMinimapOverlay()), 16);
+	TestEqual(TEXT("Nothing changed, nothing is redrawn"), Raster.Rasterize({}, {}, FRTSMinimapOverlay()), 0);
+
+	TestEqual(TEXT("The margin is outside the bounds"), Raster.GetPixel(0, 0), Style.OutsideBoundsColor);
+	TestEqual(TEXT("The edge of the bounds is outlined"), Raster.GetPixel(32, 1), Style.BoundsOutlineColor);
+	TestEqual(TEXT("The bounds are filled"), Raster.GetPixel(20, 20), Style.InsideBoundsColor);
+
+	// Top of the minimap is +X, left is -Y
+	const FVector2D Pixel = Raster.WorldToPixel(FVector(500, -500, 0));
+	TestTrue(TEXT("+X maps to the top half"), Pixel.Y < 32);
+	TestTrue(TEXT("-Y maps to the left half"), Pixel.X < 32);
+	TestTrue(TEXT("Pixels map back to the same location"), FVector2D(500, -500).Equals(Raster.PixelToWorld(Pixel), 0.01));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRTSMinimapDirtyTilesTest, "OpenRTSCamera.Minimap.DirtyTiles",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::ProductFilter)
+
+bool FRTSMinimapDirtyTilesTest::RunTest(const FString& Parameters)
+{
+	using namespace RTSMinimapTests;
+	const FRTSMinimapRaster::FStyle Style;
+	FRTSMinimapRaster Raster = MakeRaster(Style);
+	Raster.Rasterize({}, {}, FRTSMinimapOverlay());
+
+	// A 2 pixel unit around pixel (40, 40) stays inside tile (2, 2)
+	TArray<FVector> Locations = {PixelCenterToWorld(Raster, FVector2D(40.5, 40.5))};
+	const TArray<uint8> Teams = {1};
+	TestEqual(TEXT("A new unit redraws its tile only"), Raster.Rasterize(Locations, Teams, FRTSMinimapOverlay()), 1);
+	TestTrue(TEXT("The redrawn tile"), Raster.GetRedrawnTiles()[0] == FIntRect(32, 32, 48, 48));
+	TestEqual(TEXT("The unit is drawn in its team color"), Raster.GetPixel(40, 40), Style.TeamColors[1]);
+	TestEqual(TEXT("A unit that did not move redraws nothing"), Raster.Rasterize(Locations, Teams, FRTSMinimapOverlay()), 0);
+
+	// Moving it to tile (0, 0) redraws where it was and where it is
+	Locations[0] = PixelCenterToWorld(Raster, FVector2D(8.5, 8.5));
+	TestEqual(TEXT("A moved unit redraws two tiles"), Raster.Rasterize(Locations, Teams, FRTSMinimapOverlay()), 2);
+	TestEqual(TEXT("The old location is cleared"), Raster.GetPixel(40, 40), Style.InsideBoundsColor);
+	TestEqual(TEXT("The new location is drawn"), Raster.GetPixel(8, 8), Style.TeamColors[1]);
+
+	// Teams past the end of the palette use the last color
+	const TArray<uint8> UnknownTeams = {200};
+	Raster.Rasterize(Locations, UnknownTeams, FRTSMinimapOverlay());
+	TestEqual(TEXT("Unknown teams use the last color"), Raster.GetPixel(8, 8), Style.TeamColors.Last());
+
+	TestEqual(TEXT("Units off the minimap are skipped"), Raster.Rasterize({FVector(100000, 0, 0)}, {0}, FRTSMinimapOverlay()), 1);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRTSMinimapFootprintTest, "OpenRTSCamera.Minimap.Footprint",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::ProductFilter)
+
+bool FRTSMinimapFootprintTest::RunTest(const FString& Parameters)
+{
+	using namespace RTSMinimapTests;
+	const FRTSMinimapRaster::FStyle Style;
+	FRTSMinimapRaster Raster = MakeRaster(Style);
+	Raster.Rasterize({}, {}, FRTSMinimapOverlay());
+
+	FRTSMinimapOverlay Overlay;
+	TStaticArray<FVector2D, 4>& Footprint = Overlay.CameraFootprints.AddDefaulted_GetRef();
+	Footprint[0] = FVector2D(8.5, 8.5);
+	Footprint[1] = FVector2D(24.5, 8.5);
+	Footprint[2] = FVector2D(24.5, 24.5);
+	Footprint[3] = FVector2D(8.5, 24.5);
+
+	TestEqual(TEXT("The footprint redraws the tiles it spans"), Raster.Rasterize({}, {}, Overlay), 4);
+	TestEqual(TEXT("Top edge"), Raster.GetPixel(16, 8), Style.FootprintColor);
+	TestEqual(TEXT("Right edge"), Raster.GetPixel(24, 16), Style.FootprintColor);
+	TestEqual(TEXT("Inside the footprint"), Raster.GetPixel(16, 16), Style.InsideBoundsColor);
+	TestEqual(TEXT("A footprint that did not move redraws nothing"), Raster.Rasterize({}, {}, Overlay), 0);
+
+	TestEqual(TEXT("Removing the footprint redraws the same tiles"), Raster.Rasterize({}, {}, FRTSMinimapOverlay()), 4);
+	TestEqual(TEXT("The edge is cleared"), Raster.GetPixel(16, 8), Style.InsideBoundsColor);
+	return true;
+}
+
+#endif
@@ -0,0 +1,198 @@
+// Copyright 2024 Jesus Bracho All Rights Reserved.
+
+#include "RTSNetworkTestSession.h"
+
+#include "RTSCameraReplicator.h"
+#include "RTSSelectable.h"
+#include "RTSSelector.h"
+#include "GameFramework/SpringArmComponent.h"
+
+#if WITH_DEV_AUTOMATION_TESTS && WITH_EDITOR
+#include "Editor.h"
+#include "EngineUtils.h"
+#include "Misc/AutomationTest.h"
+#include "Settings/LevelEditorPlaySettings.h"
+#include "Tests/AutomationCommon.h"
+#include "Tests/AutomationEditorCommon.h"
+#endif
+
+ARTSNetworkTestRig::ARTSNetworkTestRig()
+{
+	PrimaryActorTick.bCanEverTick = false;
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+	SpringArm = CreateDefaultSubobject<USpringArmComponent>(TEXT("SpringArm"));
+	SpringArm->SetupAttachment(RootComponent);
+	SpringArm->bDoCollisionTest = false;
+	Replicator = CreateDefaultSubobject<URTSCameraReplicator>(TEXT("Replicator"));
+
+	// Remote copies must only move through the replicator, and every player spawns on the same spot
+	SetReplicatingMovement(false);
+	bAlwaysRelevant = true;
+	SpawnCollisionHandlingMethod = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+}
+
+ARTSNetworkTestUnit::ARTSNetworkTestUnit()
+{
+	PrimaryActorTick.bCanEverTick = false;
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+	Selectable = CreateDefaultSubobject<URTSSelectable>(TEXT("Selectable"));
+	bReplicates = true;
+	bAlwaysRelevant = true;
+	SpawnCollisionHandlingMethod = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+}
+
+ARTSNetworkTestPlayerController::ARTSNetworkTestPlayerController()
+{
+	Selector = CreateDefaultSubobject<URTSSelector>(TEXT("Selector"));
+	Selector->bReplicateSelection = true;
+}
+
+ARTSNetworkTestGameMode::ARTSNetworkTestGameMode()
+{
+	DefaultPawnClass = ARTSNetworkTestRig::StaticClass();
+	PlayerControllerClass = ARTSNetworkTestPlayerController::StaticClass();
+}
+
+#if WITH_DEV_AUTOMATION_TESTS && WITH_EDITOR
+
+namespace RTSNetworkTest
+{
+	/** Fills the session in once both players are in, @return Whether they are */
+	bool FindPlayers(FSession& Session)
+	{
+		for (const FWorldContext& Context : GEngine->GetWorldContexts())
+		{
+			UWorld* World = Context.World();
+			if (Context.WorldType != EWorldType::PIE || World == nullptr)
+			{
+				continue;
+			}
+
+			if (World->GetNetMode() == NM_ListenServer)
+			{
+				Session.ServerWorld = World;
+				for (auto It = World->GetPlayerControllerIterator(); It; ++It)
+				{
+					const auto Controller = Cast<ARTSNetworkTestPlayerController>(It->Get());
+					if (Controller && Controller->GetPawn())
+					{
+						(Controller->IsLocalController() ? Session.HostController : Session.ServerClientController) = Controller;
+					}
+				}
+			}
+			else if (World->GetNetMode() == NM_Client)
+			{
+				Session.ClientWorld = World;
+				const auto Controller = Cast<ARTSNetworkTestPlayerController>(World->GetFirstPlayerController());
+				if (Controller && Controller->GetPawn())
+				{
+					Session.ClientController = Controller;
+				}
+			}
+		}
+
+		if (!Session.HostController.IsValid() || !Session.ServerClientController.IsValid() || !Session.ClientController.IsValid())
+		{
+			return false;
+		}
+
+		// The host's rig has to have reached the client as well
+		int32 NumClientRigs = 0;
+		for (TActorIterator<ARTSNetworkTestRig> It(Session.ClientWorld.Get()); It; ++It)
+		{
+			++NumClientRigs;
+		}
+		return NumClientRigs >= 2;
+	}
+}
+
+TSharedRef<RTSNetworkTest::FSession> RTSNetworkTest::StartSession(FAutomationTestBase& Test, const int32 PacketLossPercentage)
+{
+	TSharedRef<FSession> Session = MakeShared<FSession>();
+	if (GEditor == nullptr || GEditor->IsPlaySessionInProgress() || FAutomationEditorCommonUtils::CreateNewMap() == nullptr)
+	{
+		Test.AddError(TEXT("Could not open an empty map to play in."));
+		Session->bFailed = true;
+		return Session;
+	}
+
+	ULevelEditorPlaySettings* PlaySettings = NewObject<ULevelEditorPlaySettings>();
+	PlaySettings->SetPlayNetMode(PIE_ListenServer);
+	PlaySettings->SetPlayNumberOfClients(2);
+	PlaySettings->SetRunUnderOneProcess(true);
+	PlaySettings->bLaunchSeparateServer = false;
+	if (PacketLossPercentage > 0)
+	{
+		PlaySettings->NetworkEmulationSettings.bIsNetworkEmulationEnabled = true;
+		PlaySettings->NetworkEmulationSettings.EmulationTarget = NetworkEmulationTarget::Any;
+		PlaySettings->NetworkEmulationSettings.OutPackets.PacketLossPercentage = PacketLossPercentage;
+		PlaySettings->NetworkEmulationSettings.InPackets.PacketLossPercentage = PacketLossPercentage;
+	}
+
+	FRequestPlaySessionParams Params;
+	Params.WorldType = EPlaySessionWorldType::PlayInEditor;
+	Params.EditorPlaySettings = PlaySettings;
+	Params.GameModeOverride = ARTSNetworkTestGameMode::StaticClass();
+	GEditor->RequestPlaySession(Params);
+
+	AddStep(Test, Session, TEXT("Both players possess a rig"), [Session]() { return FindPlayers(*Session); }, 30.0);
+	return Session;
+}
+
+void RTSNetworkTest::AddStep(FAutomationTestBase& Test, const TSharedRef<FSession>& Session, const FString& Description, TFunction<bool()>&& Step,
+                             const double Timeout)
+{
+	ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([&Test, Session, Description, Step = MoveTemp(Step), Timeout, StartSeconds = -1.0]() mutable
+	{
+		if (Session->bFailed)
+		{
+			return true;
+		}
+
+		if (StartSeconds < 0)
+		{
+			StartSeconds = FPlatformTime::Seconds();
+		}
+
+		if (Step())
+		{
+			return true;
+		}
+
+		if (FPlatformTime::Seconds() - StartSeconds > Timeout)
+		{
+			Test.AddError(FString::Printf(TEXT("Timed out after %.0f s: %s"), Timeout, *Description));
+			Session->bFailed = true;
+			return true;
+		}
+		return false;
+	}));
+}
+
+void RTSNetworkTest::AddTimedStep(const TSharedRef<FSession>& Session, const double Duration, TFunction<void(double Elapsed)>&& Step)
+{
+	ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([Session, Duration, Step = MoveTemp(Step), StartSeconds = -1.0]() mutable
+	{
+		if (Session->bFailed)
+		{
+			return true;
+		}
+
+		if (StartSeconds < 0)
+		{
+			StartSeconds = FPlatformTime::Seconds();
+		}
+
+		const double Elapsed = FMath::Min(FPlatformTime::Seconds() - StartSeconds, Duration);
+		Step(Elapsed);
+		return Elapsed >= Duration;
+	}));
+}
+
+void RTSNetworkTest::EndSession()
+{
+	ADD_LATENT_AUTOMATION_COMMAND(FEndPlayMapCommand());
+	ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([]() { return !GEditor->IsPlaySessionInProgress(); }));
+}
+
+#endif
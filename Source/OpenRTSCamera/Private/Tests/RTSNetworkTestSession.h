@@ -0,0 +1,112 @@
+// Copyright 2024 Jesus Bracho All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/GameModeBase.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+#include "Interfaces/RTSSelection.h"
+#include "RTSNetworkTestSession.generated.h"
+
+class FAutomationTestBase;
+class URTSCameraReplicator;
+class URTSSelectable;
+class URTSSelector;
+class USpringArmComponent;
+
+/** Camera rig of every player in the networked automation tests, a spring arm and a URTSCameraReplicator and nothing else */
+UCLASS(Transient, NotBlueprintable, NotPlaceable)
+class ARTSNetworkTestRig : public APawn
+{
+	GENERATED_BODY()
+
+public:
+	ARTSNetworkTestRig();
+
+	UPROPERTY()
+	USpringArmComponent* SpringArm;
+
+	UPROPERTY()
+	URTSCameraReplicator* Replicator;
+};
+
+/** Replicated selectable unit, owned by the player controller it was spawned for */
+UCLASS(Transient, NotBlueprintable, NotPlaceable)
+class ARTSNetworkTestUnit : public AActor, public IRTSSelection
+{
+	GENERATED_BODY()
+
+public:
+	ARTSNetworkTestUnit();
+
+	virtual void OnSelected_Implementation() override {}
+	virtual void OnDeselected_Implementation() override {}
+
+	UPROPERTY()
+	URTSSelectable* Selectable;
+};
+
+/** Player controller with a URTSSelector that replicates its selection */
+UCLASS(Transient, NotBlueprintable, NotPlaceable)
+class ARTSNetworkTestPlayerController : public APlayerController
+{
+	GENERATED_BODY()
+
+public:
+	ARTSNetworkTestPlayerController();
+
+	UPROPERTY()
+	URTSSelector* Selector;
+};
+
+/** Gives every player an ARTSNetworkTestPlayerController possessing an ARTSNetworkTestRig */
+UCLASS(Transient, NotBlueprintable, NotPlaceable)
+class ARTSNetworkTestGameMode : public AGameModeBase
+{
+	GENERATED_BODY()
+
+public:
+	ARTSNetworkTestGameMode();
+};
+
+#if WITH_DEV_AUTOMATION_TESTS && WITH_EDITOR
+
+/** Listen server with one client in PIE, for the tests that need a real net driver between two worlds */
+namespace RTSNetworkTest
+{
+	struct FSession
+	{
+		TWeakObjectPtr<UWorld> ServerWorld;
+		TWeakObjectPtr<UWorld> ClientWorld;
+
+		/** The listen server host, in the server world */
+		TWeakObjectPtr<ARTSNetworkTestPlayerController> HostController;
+
+		/** The client's controller as the server sees it */
+		TWeakObjectPtr<ARTSNetworkTestPlayerController> ServerClientController;
+
+		/** The client's controller in the client world */
+		TWeakObjectPtr<ARTSNetworkTestPlayerController> ClientController;
+
+		/** Set by the first step that fails, the remaining steps are skipped */
+		bool bFailed = false;
+	};
+
+	/** Opens an empty map and plays it with ARTSNetworkTestGameMode as a listen server and one client.
+	 * Steps queued after this run once both players possess their rig and see each other's.
+	 * @param PacketLossPercentage - Emulated loss of the packets going either way */
+	TSharedRef<FSession> StartSession(FAutomationTestBase& Test, int32 PacketLossPercentage = 0);
+
+	/** Queues a step that runs once per frame until it returns true, the test fails when that takes more than Timeout seconds */
+	void AddStep(FAutomationTestBase& Test, const TSharedRef<FSession>& Session, const FString& Description, TFunction<bool()>&& Step, double Timeout = 10.0);
+
+	/** Queues a step that runs once per frame for Duration seconds, with the seconds since its first frame.
+	 * The last call gets exactly Duration */
+	void AddTimedStep(const TSharedRef<FSession>& Session, double Duration, TFunction<void(double Elapsed)>&& Step);
+
+	/** Ends the PIE session, also after a failed step */
+	void EndSession();
+}
+
+#endif
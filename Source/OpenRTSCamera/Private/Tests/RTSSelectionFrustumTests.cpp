@@ -0,0 +1,95 @@
+// Copyright 2024 Jesus Bracho All Rights Reserved.
+
+#include "RTSSelectionFrustum.h"
+#include "RTSScreenProjector.h"
+#include "RTSVisibilityGrid.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace RTSSelectionFrustumTests
+{
+	/** 1000 x 1000 viewport looking down +X from the origin with a 90 degree field of view, like a player's view */
+	FRTSScreenProjector MakeProjector()
+	{
+		const FMatrix ViewRotation = FInverseRotationMatrix(FRotator::ZeroRotator) * FMatrix(
+			FPlane(0, 0, 1, 0),
+			FPlane(1, 0, 0, 0),
+			FPlane(0, 1, 0, 0),
+			FPlane(0, 0, 0, 1));
+
+		FRTSScreenProjector Projector;
+		Projector.Projection = FReversedZPerspectiveMatrix(UE_HALF_PI * 0.5, 1000.0, 1000.0, 10.0);
+		Projector.ViewProjection = ViewRotation * Projector.Projection;
+		Projector.InvViewProjection = Projector.ViewProjection.Inverse();
+		Projector.ViewRect = FIntRect(0, 0, 1000, 1000);
+		Projector.PixelsPerUnitAtUnitDepth = Projector.Projection.M[0][0] * 0.5 * Projector.ViewRect.Width();
+		return Projector;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRTSSelectionFrustumBuildTest, "OpenRTSCamera.SelectionFrustum.Build",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::ProductFilter)
+
+bool FRTSSelectionFrustumBuildTest::RunTest(const FString& Parameters)
+{
+	using namespace RTSSelectionFrustumTests;
+	const FRTSScreenProjector Projector = MakeProjector();
+
+	FVector2D Center;
+	double Depth;
+	TestTrue(TEXT("Straight ahead projects"), Projector.Project(FVector(1000, 0, 0), Center, Depth));
+	TestTrue(TEXT("Straight ahead is the middle of the screen"), Center.Equals(FVector2D(500, 500), 0.01));
+
+	FRTSSelectionFrustum Frustum;
+	TestFalse(TEXT("A click has no area"), Frustum.Build(Projector, FVector2D(500, 500), FVector2D(500.5, 500.5)));
+	TestTrue(TEXT("A box builds whatever corner it is dragged from"), Frustum.Build(Projector, FVector2D(600, 600), FVector2D(400, 400)));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRTSSelectionFrustumClassifyTest, "OpenRTSCamera.SelectionFrustum.Classify",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::ProductFilter)
+
+bool FRTSSelectionFrustumClassifyTest::RunTest(const FString& Parameters)
+{
+	using namespace RTSSelectionFrustumTests;
+
+	// At 1000 units the box covers -200 to 200 on Y and Z, the side planes go through the origin
+	FRTSSelectionFrustum Frustum;
+	Frustum.Build(MakeProjector(), FVector2D(400, 400), FVector2D(600, 600));
+
+	const TArray<FVector> Centers = {
+		FVector(1000, 0, 0),      // 0: in the middle
+		FVector(1000, 195, 0),    // 1: center inside, pokes out
+		FVector(1000, 205, 0),    // 2: center outside, pokes in
+		FVector(1000, 300, 0),    // 3: outside
+		FVector(1000, 0, -195),   // 4: center inside near the bottom edge
+		FVector(-1000, 0, 0),     // 5: behind the camera
+	};
+	const TArray<float> Radii = {10, 10, 10, 10, 10, 10};
+
+	TArray<int32> Indices;
+	Frustum.Classify(Centers, Radii, ERTSBoxSelectionTest::CenterInside, Indices);
+	TestTrue(TEXT("CenterInside"), Indices == TArray<int32>({0, 1, 4}));
+
+	Indices.Reset();
+	Frustum.Classify(Centers, Radii, ERTSBoxSelectionTest::AnyOverlap, Indices);
+	TestTrue(TEXT("AnyOverlap"), Indices == TArray<int32>({0, 1, 2, 4}));
+
+	Indices.Reset();
+	Frustum.Classify(Centers, Radii, ERTSBoxSelectionTest::FullyEnclosed, Indices);
+	TestTrue(TEXT("FullyEnclosed"), Indices == TArray<int32>({0}));
+
+	// Cells of 100 over X 0..2000 and Y -500..500, every one visible but the cell around (1000, 0)
+	FRTSVisibilityGrid Grid;
+	Grid.Initialize(FVector2D(0, -500), 100, 20, 10);
+	Grid.SetAllVisible(true);
+	Grid.SetCellVisible(10, 5, false);
+
+	Indices.Reset();
+	Frustum.Classify(Centers, Radii, ERTSBoxSelectionTest::AnyOverlap, Indices, &Grid);
+	TestTrue(TEXT("AnyOverlap skips the fogged cell"), Indices == TArray<int32>({1, 2}));
+	return true;
+}
+
+#endif
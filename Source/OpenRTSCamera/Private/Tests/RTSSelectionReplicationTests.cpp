@@ -0,0 +1,307 @@
+// Copyright 2024 Jesus Bracho All Rights Reserved.
+
+#include "RTSSelectionReplication.h"
+#include "RTSNetworkTestSession.h"
+#include "Misc/AutomationTest.h"
+#include "Serialization/BitReader.h"
+#include "Serialization/BitWriter.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#if WITH_EDITOR
+#include "EngineUtils.h"
+#include "RTSSelectable.h"
+#include "RTSSelectableRegistry.h"
+#include "RTSSelector.h"
+#endif
+
+namespace RTSSelectionReplicationTests
+{
+	TBitArray<> MakeBits(const int32 NumBits, std::initializer_list<int32> SetBits)
+	{
+		TBitArray<> Bits(false, NumBits);
+		for (const int32 Bit : SetBits)
+		{
+			Bits[Bit] = true;
+		}
+		return Bits;
+	}
+
+#if WITH_EDITOR
+	constexpr int32 NumClientUnits = 200;
+
+	/** Net id of the unit deselected by the one unit toggle */
+	constexpr int32 ToggledNetId = 100;
+
+	struct FListenServerState
+	{
+		/** Units of the client as the server sees them, in net id order */
+		TArray<TWeakObjectPtr<AActor>> ServerUnits;
+
+		/** Unit of the host, the client is not allowed to select it */
+		TWeakObjectPtr<AActor> ServerHostUnit;
+
+		/** Units of the client in the client world, in net id order */
+		TArray<TWeakObjectPtr<AActor>> ClientUnits;
+		TWeakObjectPtr<AActor> ClientHostUnit;
+
+		int32 BoxSelectionBytes = 0;
+		int32 ToggleBytes = 0;
+		int32 ReleasedNetId = INDEX_NONE;
+	};
+
+	AActor* SpawnUnit(UWorld* World, AActor* Owner, const int32 Index)
+	{
+		FActorSpawnParameters SpawnParameters;
+		SpawnParameters.Owner = Owner;
+		return World->SpawnActor<ARTSNetworkTestUnit>(FVector(Index % 20 * 200, Index / 20 * 200, 0), FRotator::ZeroRotator, SpawnParameters);
+	}
+
+	int32 GetNetId(const AActor* Unit)
+	{
+		return CastChecked<ARTSNetworkTestUnit>(Unit)->Selectable->SelectableNetId;
+	}
+
+	TArray<AActor*> ResolveUnits(const TArray<TWeakObjectPtr<AActor>>& Units)
+	{
+		TArray<AActor*> Actors;
+		for (const TWeakObjectPtr<AActor>& Unit : Units)
+		{
+			if (Unit.IsValid())
+			{
+				Actors.Add(Unit.Get());
+			}
+		}
+		return Actors;
+	}
+#endif
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRTSSelectionBitsetRunsTest, "OpenRTSCamera.SelectionReplication.Runs",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::ProductFilter)
+
+bool FRTSSelectionBitsetRunsTest::RunTest(const FString& Parameters)
+{
+	using namespace RTSSelectionReplicationTests;
+
+	const TBitArray<> Bits = MakeBits(100, {3, 4, 5, 6, 7, 8, 9, 50, 99});
+	FBitWriter Writer(0, true);
+	FRTSSelectionBitsetCodec::WriteRuns(Writer, Bits);
+
+	FBitReader Reader(Writer.GetData(), Writer.GetNumBits());
+	TBitArray<> Decoded;
+	TestTrue(TEXT("Decodes"), FRTSSelectionBitsetCodec::ReadRuns(Reader, 1 << 16, Decoded));
+	TestFalse(TEXT("Round trips"), FRTSSelectionBitsetCodec::HasDifferences(Bits, Decoded));
+
+	// Box selections of units spawned together are one run of ones, whatever their count
+	TBitArray<> Box(false, 1200);
+	Box.SetRange(1000, 200, true);
+	FBitWriter BoxWriter(0, true);
+	FRTSSelectionBitsetCodec::WriteRuns(BoxWriter, Box);
+	TestTrue(TEXT("A box of 200 units fits in a handful of bytes"), BoxWriter.GetNumBytes() <= 8);
+
+	FBitWriter EmptyWriter(0, true);
+	FRTSSelectionBitsetCodec::WriteRuns(EmptyWriter, TBitArray<>(false, 64));
+	FBitReader EmptyReader(EmptyWriter.GetData(), EmptyWriter.GetNumBits());
+	TestTrue(TEXT("An empty selection decodes"), FRTSSelectionBitsetCodec::ReadRuns(EmptyReader, 1 << 16, Decoded));
+	TestEqual(TEXT("An empty selection has no bits"), Decoded.Num(), 0);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRTSSelectionBitsetDeltaTest, "OpenRTSCamera.SelectionReplication.Delta",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::ProductFilter)
+
+bool FRTSSelectionBitsetDeltaTest::RunTest(const FString& Parameters)
+{
+	using namespace RTSSelectionReplicationTests;
+
+	const TBitArray<> Previous = MakeBits(10, {1, 2, 3});
+	const TBitArray<> Current = MakeBits(600, {2, 3, 4, 500});
+	TestTrue(TEXT("Differences are found across sizes"), FRTSSelectionBitsetCodec::HasDifferences(Previous, Current));
+	TestFalse(TEXT("Trailing unset bits are not a difference"), FRTSSelectionBitsetCodec::HasDifferences(Previous, MakeBits(64, {1, 2, 3})));
+
+	FBitWriter Writer(0, true);
+	FRTSSelectionBitsetCodec::WriteDelta(Writer, Previous, Current);
+
+	FBitReader Reader(Writer.GetData(), Writer.GetNumBits());
+	TBitArray<> Applied = Previous;
+	TestTrue(TEXT("Decodes"), FRTSSelectionBitsetCodec::ReadDelta(Reader, 1 << 16, Applied));
+	TestFalse(TEXT("Applying the delta to the previous bits gives the current bits"), FRTSSelectionBitsetCodec::HasDifferences(Applied, Current));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRTSSelectionBitsetMalformedTest, "OpenRTSCamera.SelectionReplication.Malformed",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::ProductFilter)
+
+bool FRTSSelectionBitsetMalformedTest::RunTest(const FString& Parameters)
+{
+	using namespace RTSSelectionReplicationTests;
+
+	FBitWriter Writer(0, true);
+	FRTSSelectionBitsetCodec::WriteRuns(Writer, MakeBits(300, {10, 200, 299}));
+
+	FBitReader TooLong(Writer.GetData(), Writer.GetNumBits());
+	TBitArray<> Decoded;
+	TestFalse(TEXT("Payloads growing past the limit are rejected"), FRTSSelectionBitsetCodec::ReadRuns(TooLong, 100, Decoded));
+
+	FBitReader Truncated(Writer.GetData(), Writer.GetNumBits() / 2);
+	TestFalse(TEXT("Truncated payloads are rejected"), FRTSSelectionBitsetCodec::ReadRuns(Truncated, 1 << 16, Decoded));
+	return true;
+}
+
+
+#if WITH_EDITOR
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRTSSelectionReplicationListenServerTest, "OpenRTSCamera.SelectionReplication.ListenServer",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FRTSSelectionReplicationListenServerTest::RunTest(const FString& Parameters)
+{
+	using namespace RTSSelectionReplicationTests;
+	const TSharedRef<RTSNetworkTest::FSession> Session = RTSNetworkTest::StartSession(*this);
+	const TSharedRef<FListenServerState> State = MakeShared<FListenServerState>();
+
+	// Nothing else is selectable, the units get the net ids 0 to NumClientUnits in spawn order
+	RTSNetworkTest::AddStep(*this, Session, TEXT("Spawn the units"), [Session, State]()
+	{
+		for (int32 Index = 0; Index < NumClientUnits; ++Index)
+		{
+			State->ServerUnits.Add(SpawnUnit(Session->ServerWorld.Get(), Session->ServerClientController.Get(), Index));
+		}
+		State->ServerHostUnit = SpawnUnit(Session->ServerWorld.Get(), Session->HostController.Get(), NumClientUnits);
+		return true;
+	});
+
+	RTSNetworkTest::AddStep(*this, Session, TEXT("The client binds the net ids of every unit"), [this, Session, State]()
+	{
+		const auto Registry = Session->ClientWorld->GetSubsystem<URTSSelectableRegistry>();
+		TArray<AActor*> Units;
+		for (TActorIterator<ARTSNetworkTestUnit> It(Session->ClientWorld.Get()); It; ++It)
+		{
+			if (Registry->GetNetId(*It) == INDEX_NONE)
+			{
+				return false;
+			}
+			Units.Add(*It);
+		}
+		if (Units.Num() != NumClientUnits + 1)
+		{
+			return false;
+		}
+
+		Units.Sort([](const AActor& A, const AActor& B) { return GetNetId(&A) < GetNetId(&B); });
+		for (int32 Index = 0; Index < NumClientUnits; ++Index)
+		{
+			TestEqual(TEXT("Net ids are handed out in spawn order"), GetNetId(Units[Index]), Index);
+			TestTrue(TEXT("The client owns its units"), Units[Index]->GetOwner() == Session->ClientController.Get());
+			State->ClientUnits.Add(Units[Index]);
+		}
+		State->ClientHostUnit = Units.Last();
+		return true;
+	});
+
+	RTSNetworkTest::AddStep(*this, Session, TEXT("Box select every unit of the client"), [Session, State]()
+	{
+		URTSSelector* Selector = Session->ClientController->Selector;
+		Selector->HandleSelectedActors(ResolveUnits(State->ClientUnits));
+		State->BoxSelectionBytes = Selector->GetLastSelectionChangeBytes();
+		return true;
+	});
+
+	RTSNetworkTest::AddStep(*this, Session, TEXT("The server validates the box selection"), [this, Session, State]()
+	{
+		const URTSSelector* ServerSelector = Session->ServerClientController->Selector;
+		if (ServerSelector->AuthoritativeSelectedActors.Num() != NumClientUnits)
+		{
+			return false;
+		}
+
+		// One run of zeros and one run of ones, whatever the number of units
+		TestEqual(TEXT("Box selection bytes"), State->BoxSelectionBytes, 4);
+		TestEqual(TEXT("The server receives what the client sent"), ServerSelector->GetLastSelectionChangeBytes(), State->BoxSelectionBytes);
+		return true;
+	});
+
+	RTSNetworkTest::AddStep(*this, Session, TEXT("Deselect one unit"), [Session, State]()
+	{
+		TArray<AActor*> Units = ResolveUnits(State->ClientUnits);
+		Units.RemoveAt(ToggledNetId);
+		URTSSelector* Selector = Session->ClientController->Selector;
+		Selector->HandleSelectedActors(Units);
+		State->ToggleBytes = Selector->GetLastSelectionChangeBytes();
+		return true;
+	});
+
+	RTSNetworkTest::AddStep(*this, Session, TEXT("The server drops the deselected unit"), [this, Session, State]()
+	{
+		const URTSSelector* ServerSelector = Session->ServerClientController->Selector;
+		if (ServerSelector->AuthoritativeSelectedActors.Num() != NumClientUnits - 1)
+		{
+			return false;
+		}
+
+		// A run up to the flipped bit and a run of one
+		TestEqual(TEXT("One unit toggle bytes"), State->ToggleBytes, 3);
+		TestFalse(TEXT("The deselected unit is gone"), ServerSelector->AuthoritativeSelectedActors.Contains(State->ServerUnits[ToggledNetId].Get()));
+		return true;
+	});
+
+	RTSNetworkTest::AddStep(*this, Session, TEXT("Try to select the host's unit"), [Session, State]()
+	{
+		URTSSelector* Selector = Session->ClientController->Selector;
+		TArray<AActor*> Units = Selector->SelectedActors;
+		Units.Add(State->ClientHostUnit.Get());
+		Selector->HandleSelectedActors(Units);
+		return true;
+	});
+
+	RTSNetworkTest::AddStep(*this, Session, TEXT("The server rejects the host's unit"), [this, Session, State]()
+	{
+		const URTSSelector* Selector = Session->ClientController->Selector;
+		const URTSSelector* ServerSelector = Session->ServerClientController->Selector;
+		if (Selector->IsActorSelected(State->ClientHostUnit.Get()))
+		{
+			return false;
+		}
+
+		TestEqual(TEXT("The client keeps its own units"), Selector->SelectedActors.Num(), NumClientUnits - 1);
+		TestEqual(TEXT("The server keeps the client's units"), ServerSelector->AuthoritativeSelectedActors.Num(), NumClientUnits - 1);
+		TestFalse(TEXT("The server never lets the host's unit through"), ServerSelector->AuthoritativeSelectedActors.Contains(State->ServerHostUnit.Get()));
+		return true;
+	});
+
+	// The client still claims the destroyed unit's id until it hears about it, a new unit must not be handed that id meanwhile
+	RTSNetworkTest::AddStep(*this, Session, TEXT("Destroy a selected unit and spawn another"), [this, Session, State]()
+	{
+		AActor* Destroyed = State->ServerUnits[0].Get();
+		State->ReleasedNetId = GetNetId(Destroyed);
+		Destroyed->Destroy();
+
+		const AActor* Spawned = SpawnUnit(Session->ServerWorld.Get(), Session->ServerClientController.Get(), NumClientUnits + 1);
+		TestNotEqual(TEXT("A claimed net id is not reused"), GetNetId(Spawned), State->ReleasedNetId);
+		return true;
+	});
+
+	RTSNetworkTest::AddStep(*this, Session, TEXT("The client drops the destroyed unit"), [this, Session, State]()
+	{
+		const URTSSelector* ServerSelector = Session->ServerClientController->Selector;
+		if (Session->ClientController->Selector->SelectedActors.Num() != NumClientUnits - 2 || ServerSelector->AuthoritativeSelectedActors.Num() != NumClientUnits - 2)
+		{
+			return false;
+		}
+
+		const AActor* Spawned = SpawnUnit(Session->ServerWorld.Get(), Session->ServerClientController.Get(), NumClientUnits + 2);
+		TestEqual(TEXT("The net id is reused once nobody claims it"), GetNetId(Spawned), State->ReleasedNetId);
+
+		AddInfo(FString::Printf(TEXT("Bytes per selection change: %d for a %d unit box selection, %d for a one unit toggle, %.1f on average"),
+		                        State->BoxSelectionBytes, NumClientUnits, State->ToggleBytes, ServerSelector->GetAverageBytesPerSelectionChange()));
+		return true;
+	});
+
+	RTSNetworkTest::EndSession();
+	return true;
+}
+
+#endif
+
+#endif
@@ -0,0 +1,43 @@
+// Copyright 2024 Jesus Bracho All Rights Reserved.
+
+#include "RTSSelectionRings.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRTSSelectionRingBufferTest, "OpenRTSCamera.SelectionRings.Buffer",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::ProductFilter)
+
+bool FRTSSelectionRingBufferTest::RunTest(const FString& Parameters)
+{
+	// Only the addresses are used as keys
+	const int32 Units[3] = {};
+	FRTSSelectionRingBuffer Buffer;
+
+	TestEqual(TEXT("First ring"), Buffer.Add(&Units[0], FTransform(FVector(0, 0, 0))), 0);
+	TestEqual(TEXT("Second ring"), Buffer.Add(&Units[1], FTransform(FVector(100, 0, 0))), 1);
+	TestEqual(TEXT("Third ring"), Buffer.Add(&Units[2], FTransform(FVector(200, 0, 0))), 2);
+	TestEqual(TEXT("A key has one ring"), Buffer.Add(&Units[1], FTransform::Identity), 1);
+	TestTrue(TEXT("New rings are dirty"), Buffer.IsDirty() && Buffer.GetFirstDirty() == 0 && Buffer.GetLastDirty() == 2);
+
+	// Removing the first ring moves the last one into its instance
+	Buffer.ClearDirty();
+	TestTrue(TEXT("Removes"), Buffer.Remove(&Units[0]));
+	TestFalse(TEXT("Removes once"), Buffer.Remove(&Units[0]));
+	TestEqual(TEXT("The last ring fills the hole"), Buffer.Find(&Units[2]), 0);
+	TestTrue(TEXT("The moved ring keeps its transform"), Buffer.GetTransforms()[0].GetLocation().Equals(FVector(200, 0, 0)));
+	TestTrue(TEXT("Only the moved instance is dirty"), Buffer.GetFirstDirty() == 0 && Buffer.GetLastDirty() == 0);
+
+	// Removing the last ring leaves nothing to upload
+	Buffer.ClearDirty();
+	Buffer.Remove(&Units[1]);
+	TestFalse(TEXT("The dirty range never points past the end"), Buffer.IsDirty());
+	TestEqual(TEXT("One ring left"), Buffer.Num(), 1);
+
+	TestFalse(TEXT("Moves within the tolerance are ignored"), Buffer.Update(0, FTransform(FVector(205, 0, 0)), 10));
+	TestTrue(TEXT("Larger moves are stored"), Buffer.Update(0, FTransform(FVector(250, 0, 0)), 10));
+	TestTrue(TEXT("And marked dirty"), Buffer.IsDirty());
+	return true;
+}
+
+#endif
@@ -0,0 +1,84 @@
+// Copyright 2024 Jesus Bracho All Rights Reserved.
+
+#include "RTSVisibilityGrid.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRTSVisibilityGridTest, "OpenRTSCamera.VisibilityGrid",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::ProductFilter)
+
+bool FRTSVisibilityGridTest::RunTest(const FString& Parameters)
+{
+	// 10 x 10 cells of 100 cm starting at (-500, -500), 100 bits over two words
+	FRTSVisibilityGrid Grid;
+	Grid.Initialize(FVector2D(-500, -500), 100, 10, 10);
+	TestFalse(TEXT("Cells start hidden"), Grid.IsVisible(FVector(0, 0, 0)));
+
+	Grid.SetCellVisible(5, 5, true);
+	TestTrue(TEXT("A visible cell"), Grid.IsVisible(FVector(50, 50, 1000)));
+	TestFalse(TEXT("Its neighbour"), Grid.IsVisible(FVector(150, 50, 0)));
+
+	// Cell (4, 9) is bit 94, in the second word
+	Grid.SetCellVisible(4, 9, true);
+	TestTrue(TEXT("A cell in the second word"), Grid.IsVisible(FVector(-50, 450, 0)));
+
+	TestFalse(TEXT("Outside the grid is hidden"), Grid.IsVisible(FVector(-600, 0, 0)));
+	Grid.SetAllVisible(true);
+	TestFalse(TEXT("Outside the grid stays hidden"), Grid.IsVisible(FVector(600, 0, 0)));
+	TestTrue(TEXT("Every cell inside is visible"), Grid.IsVisible(FVector(-450, 450, 0)));
+
+	TestFalse(TEXT("A word count that does not match is rejected"), Grid.SetWords(TArray<uint64>({0})));
+	TestTrue(TEXT("A matching word count is accepted"), Grid.SetWords(TArray<uint64>({1, 0})));
+	TestTrue(TEXT("Bit 0 is cell (0, 0)"), Grid.IsVisible(FVector(-450, -450, 0)));
+	TestFalse(TEXT("Other cells follow the words"), Grid.IsVisible(FVector(-350, -450, 0)));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRTSVisibilityGridLargeTest, "OpenRTSCamera.VisibilityGrid.Large",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::ProductFilter)
+
+bool FRTSVisibilityGridLargeTest::RunTest(const FString& Parameters)
+{
+	// 4100 x 4100 cells over +-2 km: 16.81M bits, past 2^24, and a cell size that is no power of two nor has an exact inverse
+	constexpr int32 Size = 4100;
+	constexpr double Origin = -200000;
+	const float CellSize = 400000.0f / Size;
+	FRTSVisibilityGrid Grid;
+	Grid.Initialize(FVector2D(Origin, Origin), CellSize, Size, Size);
+
+	const auto CellEdge = [CellSize](const int32 Cell) { return Origin + static_cast<double>(Cell) * CellSize; };
+	const auto CellCenter = [CellSize](const int32 Cell) { return Origin + (Cell + 0.5) * CellSize; };
+
+	// Bit 16809999, the last cell, sits in the last word which the grid only partly fills
+	Grid.SetCellVisible(Size - 1, Size - 1, true);
+	TestTrue(TEXT("The last cell"), Grid.IsVisible(FVector(CellCenter(Size - 1), CellCenter(Size - 1), 0)));
+	TestFalse(TEXT("The cell before it"), Grid.IsVisible(FVector(CellCenter(Size - 2), CellCenter(Size - 1), 0)));
+	TestFalse(TEXT("The far edge is outside"), Grid.IsVisible(FVector(CellEdge(Size), CellCenter(Size - 1), 0)));
+
+	// Row 4092 starts at bit 16777200, cell 100 of it is bit 16777300, past 2^24
+	Grid.SetCellVisible(100, 4092, true);
+	TestTrue(TEXT("A cell past bit 2^24"), Grid.IsVisible(FVector(CellCenter(100), CellCenter(4092), 0)));
+	TestFalse(TEXT("The same column one row down"), Grid.IsVisible(FVector(CellCenter(100), CellCenter(4091), 0)));
+
+	// A location on the edge between two cells belongs to the cell that starts there, all the way to +2 km
+	bool bEdgesRound = true;
+	for (const int32 Cell : {1, 2, 3, 1023, 2049, 3001, 4095, 4096, Size - 1})
+	{
+		Grid.SetAllVisible(false);
+		Grid.SetCellVisible(Cell, 0, true);
+		const double Y = CellCenter(0);
+		if (!Grid.IsVisible(FVector(CellEdge(Cell), Y, 0))
+			|| Grid.IsVisible(FVector(CellEdge(Cell) - 0.01, Y, 0))
+			|| !Grid.IsVisible(FVector(CellEdge(Cell + 1) - 0.01, Y, 0))
+			|| Grid.IsVisible(FVector(CellEdge(Cell + 1), Y, 0)))
+		{
+			AddError(FString::Printf(TEXT("Edges of cell %d at %.4f round to the wrong cell"), Cell, CellEdge(Cell)));
+			bEdgesRound = false;
+		}
+	}
+	TestTrue(TEXT("Cell edges round to the cell that starts there"), bEdgesRound);
+	return true;
+}
+
+#endif
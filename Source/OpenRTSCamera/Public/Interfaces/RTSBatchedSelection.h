@@ -0,0 +1,30 @@
+// Copyright 2024 Jesus Bracho All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Native fast path for C++ units. Registered per class on URTSSelectableRegistry, the handler gets every unit of its
+ * classes that entered or left a selection in one virtual call, instead of one OnSelected/OnDeselected ProcessEvent
+ * per actor. Units still have to implement IRTSSelection to be selectable, handlers must not change a selection.
+ */
+class OPENRTSCAMERA_API IRTSBatchedSelectionHandler
+{
+public:
+	virtual ~IRTSBatchedSelectionHandler() = default;
+
+	virtual void OnSelectedBatch(TConstArrayView<AActor*> Actors) = 0;
+	virtual void OnDeselectedBatch(TConstArrayView<AActor*> Actors) = 0;
+};
+
+/** How selection events reach the units of one class, resolved once per class */
+struct FRTSSelectionDispatch
+{
+	/** Owned by the registry, null for classes that only have the interface events */
+	IRTSBatchedSelectionHandler* Handler = nullptr;
+
+	/** A Blueprint overrides the interface event, it keeps firing per actor next to the handler */
+	bool bScriptOnSelected = false;
+	bool bScriptOnDeselected = false;
+};
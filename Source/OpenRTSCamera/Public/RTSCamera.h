@@ -7,8 +7,15 @@
 #include "Camera/CameraComponent.h"
 #include "Components/ActorComponent.h"
 #include "GameFramework/SpringArmComponent.h"
+#include "RTSCameraSmoothing.h"
+#include "RTSCameraSubsystem.h"
+#include "RTSCameraTransition.h"
+#include "RTSFollowGroup.h"
+#include "RTSSignificanceSubsystem.h"
 #include "RTSCamera.generated.h"
 
+struct FStreamableHandle;
+
 /**
  * We use these commands so that move camera inputs can be tied to the tick rate of the game.
  * https://github.com/HeyZoos/OpenRTSCamera/issues/27
@@ -30,6 +37,9 @@ class OPENRTSCAMERA_API URTSCamera : public UActorComponent
 {
 	GENERATED_BODY()
 
+	/** The subsystem drives TickRig() for every camera of the world in one batched pass */
+	friend class URTSCameraSubsystem;
+
 public:
 	URTSCamera();
 
@@ -43,22 +53,77 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "RTSCamera")
 	void UnFollowTarget();
 
+	/** Follows the centroid of a group (the selection, a control group...) and zooms to keep every member in frame.
+	 * Members are tracked through their own movement events and dropped when they end play, nothing is rescanned per frame.
+	 * Replaces any target or group followed so far, use UnFollowTarget() to stop */
+	UFUNCTION(BlueprintCallable, Category = "RTSCamera")
+	void FollowGroup(const TArray<AActor*>& Members);
+
+	/** Should following a group change the zoom so every member stays in frame? */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera|FollowGroup")
+	bool FollowGroupAdjustsZoom;
+
+	/** Multiplier on the extent of the group (centroid to its farthest bounds corner) when framing it, 1 puts the farthest member on the edge */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera|FollowGroup", meta=(EditCondition="FollowGroupAdjustsZoom", ClampMin = "0.1"))
+	float FollowGroupFraming;
+
+	/** How fast the followed center and framing catch up with the group, 0 follows it exactly but jitters while members spread out */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera|FollowGroup", meta = (ClampMin = "0.0"))
+	float FollowGroupSmoothing;
+
 	UFUNCTION(BlueprintCallable, Category = "RTSCamera")
 	void SetCameraZoom(const float NewZoomDistance,  const bool bSmoothLerp) ;
 
 	UFUNCTION(BlueprintCallable, Category = "RTSCamera")
 	void SetActiveCamera() const;
 
-	/** Slerps the camera position to the given position
-	 * @param Position - The position we want to slerp towards */
+	/** Flies the camera to the given position along a precomputed arc (see JumpTransition), any camera input cancels it.
+	 * The destination is clamped to the camera bounds and stops following any target
+	 * @param Position - The position we want to fly to */
+	UFUNCTION(BlueprintCallable, Category = "RTSCamera")
+	void JumpTo(const FVector Position);
+	void JumpTo(const AActor* Actor);
+
+	/** Is a JumpTo() or JumpToBookmark() flight in progress? */
+	UFUNCTION(BlueprintPure, Category = "RTSCamera")
+	bool IsJumping() const { return Transition.IsActive(); }
+
+	/** Stops the current flight where it is */
 	UFUNCTION(BlueprintCallable, Category = "RTSCamera")
-	void JumpTo(const FVector Position) const;
-	void JumpTo(const AActor* Actor) const;
+	void CancelJump();
+
+	/** Stores the current position, yaw and zoom under the name, replacing any bookmark of the same name */
+	UFUNCTION(BlueprintCallable, Category = "RTSCamera|Bookmarks")
+	void SaveBookmark(FName Name);
+
+	/** Restores the position, yaw and zoom stored under the name
+	 * @return False if there is no such bookmark */
+	UFUNCTION(BlueprintCallable, Category = "RTSCamera|Bookmarks")
+	bool JumpToBookmark(FName Name);
+
+	UFUNCTION(BlueprintCallable, Category = "RTSCamera|Bookmarks")
+	void RemoveBookmark(FName Name);
+
+	/** Position, yaw and zoom of the rig right now */
+	UFUNCTION(BlueprintPure, Category = "RTSCamera|Bookmarks")
+	FRTSCameraBookmark GetCurrentView() const;
+
+	/** Current arm length of the rig, how far the camera is zoomed out */
+	UFUNCTION(BlueprintPure, Category = "RTSCamera")
+	float GetZoomLength() const;
+
+	/** The player controller this rig reads input from and renders for */
+	APlayerController* GetPlayerController() const { return PlayerController; }
+
+	/** Where the cursor meets the ground this frame, shared with every other consumer so nobody needs their own trace */
+	UFUNCTION(BlueprintPure, Category = "RTSCamera")
+	FRTSCursorGroundHit GetCursorGroundHit() const;
 
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera|ZoomSettings")
 	float MinimumZoomLength;
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera|ZoomSettings")
 	float MaximumZoomLength;
+	/** How fast the arm length and the height above ground catch up, the inverse of the smoothing time constant */
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera|ZoomSettings")
 	float ZoomCatchupSpeed;
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera|ZoomSettings")
@@ -76,6 +141,14 @@ public:
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera")
 	float MoveSpeed;
 
+	/** How zoom, height, yaw and group follow ease toward their targets, both are frame rate independent */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera")
+	ERTSCameraSmoothingMode SmoothingMode;
+
+	/** How fast incremental turns ease to the new yaw, 0 snaps to it */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera|Rotation", meta = (EditCondition = "bUseIncrementalRotation", ClampMin = "0.0"))
+	float TurnCatchupSpeed;
+
 	/** Should we allow rotating by an incremental value upon tapping the hit button?*/
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera|Rotation")
 	bool bUseIncrementalRotation = false;
@@ -123,27 +196,60 @@ public:
 	UPROPERTY(BlueprintReadWrite,EditAnywhere,Category = "RTSCamera|EdgeScrollSettings",meta=(EditCondition="EnableEdgeScrolling"))
 	float DistanceFromEdgeThreshold;
 
-	/** Input actions */
+	/** Fly to JumpTo() destinations and bookmarks instead of teleporting */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera|Transition")
+	bool EnableSmoothJumps;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera|Transition", meta=(EditCondition="EnableSmoothJumps"))
+	FRTSCameraTransitionSettings JumpTransition;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera|Bookmarks")
+	TMap<FName, FRTSCameraBookmark> Bookmarks;
+
+	/** Feed the camera footprint to the significance subsystem so registered selectables throttle their ticking, animation and widgets */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera|Significance")
+	bool EnableSignificance;
+
+	/** Ordered from most to least significant, a unit lands in the first bucket whose MaxDistance it is within.
+	 * The bucket settings are per world: the first rig to begin play with significance enabled sets them */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera|Significance", meta=(EditCondition="EnableSignificance"))
+	TArray<FRTSSignificanceBucketSettings> SignificanceBuckets;
+
+	/** Beyond this arm length every unit is pushed one bucket further down, 0 disables it */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera|Significance", meta=(EditCondition="EnableSignificance"))
+	float ZoomedOutSignificanceLength;
+
+	/** The footprint is where the view corners meet the ground, corners that look above the horizon or further away
+	 * than this count as this far from the camera, in cm */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera|Significance", meta=(EditCondition="EnableSignificance", ClampMin = "0"))
+	float SignificanceFootprintMaxDistance;
+
+	/** How many units get re-bucketed per frame */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera|Significance", meta=(EditCondition="EnableSignificance", ClampMin = "1"))
+	int32 SignificanceUpdateBudget;
+
+	/** Input actions, soft so loading the class does not load them. They are streamed in on BeginPlay and bound once
+	 * they arrive, the rig ignores input until then */
 	
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera|Inputs")
-	UInputMappingContext* InputMappingContext;
+	TSoftObjectPtr<UInputMappingContext> InputMappingContext;
 	
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera|Inputs")
-	UInputAction* TurnCameraLeft;
+	TSoftObjectPtr<UInputAction> TurnCameraLeft;
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera|Inputs")
-	UInputAction* TurnCameraRight;
+	TSoftObjectPtr<UInputAction> TurnCameraRight;
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera|Inputs")
-	UInputAction* MoveCameraYAxis;
+	TSoftObjectPtr<UInputAction> MoveCameraYAxis;
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera|Inputs")
-	UInputAction* MoveCameraXAxis;
+	TSoftObjectPtr<UInputAction> MoveCameraXAxis;
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera|Inputs")
-	UInputAction* DragCamera;
+	TSoftObjectPtr<UInputAction> DragCamera;
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera|Inputs")
-	UInputAction* ZoomCamera;
+	TSoftObjectPtr<UInputAction> ZoomCamera;
 
 protected:
 	virtual void BeginPlay() override;
-	virtual void TickComponent(float DeltaTime,ELevelTick TickType,FActorComponentTickFunction* ThisTickFunction) override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 	void OnZoomCamera(const FInputActionValue& Value);
 	void OnRotateCameraLeft(const FInputActionValue& Value);
@@ -174,11 +280,26 @@ protected:
 	
 	UPROPERTY()
 	AActor* BoundaryVolume;
+
+	UPROPERTY()
+	URTSSignificanceSubsystem* Significance;
+
+	UPROPERTY()
+	URTSCameraSubsystem* CameraSubsystem;
 	
 	UPROPERTY()
 	float DesiredZoomLength;
 
 private:
+	void TickRig(float DeltaTime, const FRTSCameraInputSnapshot& Input);
+
+	/** The local controller possessing our owner, null for pawns that are not locally controlled. Owners that are not
+	 * pawns fall back to the first local player */
+	APlayerController* ResolvePlayerController() const;
+
+	UFUNCTION()
+	void OnOwnerControllerChanged(APawn* Pawn, AController* OldController, AController* NewController);
+
 	void CollectComponentDependencyReferences();
 	void ConfigureSpringArm();
 	void TryToFindBoundaryVolumeReference();
@@ -187,6 +308,10 @@ private:
 	void BindInputMappingContext() const;
 	void BindInputActions();
 
+	/** Binds right away when the input assets are in memory, otherwise once they are streamed in */
+	void RequestInputAssets();
+	void OnInputAssetsLoaded();
+
 	void ConditionallyPerformEdgeScrolling() const;
 	void EdgeScrollLeft() const;
 	void EdgeScrollRight() const;
@@ -194,13 +319,55 @@ private:
 	void EdgeScrollDown() const;
 
 	void SetCameraStartingTransform();
+	void StartTransition(FRTSCameraBookmark Destination);
+	void AdvanceTransition();
+	void ApplyView(const FRTSCameraBookmark& View);
+	FVector ClampToBounds(const FVector& Location) const;
 	void FollowTargetIfSet() const;
-	void SmoothTargetArmLengthToDesiredZoom() const;
+	void AdvanceSmoothing();
+	void ClearFollowGroup();
+	void OnFollowGroupMemberMoved(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport);
+
+	UFUNCTION()
+	void OnFollowGroupMemberEndPlay(AActor* Actor, EEndPlayReason::Type EndPlayReason);
 	void ConditionallyKeepCameraAtDesiredZoomAboveGround();
 	void ConditionallyApplyCameraBounds() const;
+	void ConditionallyReportSignificanceViewpoint() const;
 	
 	UPROPERTY()
 	AActor* CameraFollowTarget;
+
+	/** Members we are bound to, only used to unbind */
+	TArray<TWeakObjectPtr<AActor>> FollowGroupMembers;
+
+	FRTSFollowGroup FollowGroupState;
+	FRTSCameraTransition Transition;
+
+	/** Set while the input assets are streaming in */
+	TSharedPtr<FStreamableHandle> InputAssetsHandle;
+	double InputAssetsRequestTime = 0;
+
+	/** Keeps the streamed input assets loaded while they are bound, the soft pointers alone do not */
+	UPROPERTY()
+	TArray<UObject*> LoadedInputAssets;
+
+	TRTSSmoothedChannel<float> ZoomSmoothing;
+	TRTSSmoothedChannel<float> HeightSmoothing;
+	TRTSSmoothedChannel<float> YawSmoothing;
+	TRTSSmoothedChannel<FVector> FollowCenterSmoothing;
+	TRTSSmoothedChannel<float> FollowRadiusSmoothing;
+
+	/** Set while the ground below the rig is known and nothing else owns its height */
+	TOptional<float> GroundHeightTarget;
+
+	/** Set while an incremental turn is easing in */
+	TOptional<float> DesiredYaw;
+
+	/** Latest drag offset, normalized to the drag extents */
+	FVector2D PendingDragDelta = FVector2D::ZeroVector;
+	bool bHasPendingDrag = false;
+	FVector SmoothedFollowGroupCenter = FVector::ZeroVector;
+	float SmoothedFollowGroupRadius = 0;
 	
 	UPROPERTY()
 	float DeltaSeconds;
@@ -210,6 +377,10 @@ private:
 	
 	UPROPERTY()
 	FVector2D DragStartLocation;
+
+	/** Mouse state of our player controller for this frame, shared with every other rig of the same controller */
+	UPROPERTY()
+	FRTSCameraInputSnapshot InputSnapshot;
 	
 	UPROPERTY()
 	TArray<FMoveCameraCommand> MoveCameraCommands;
@@ -0,0 +1,185 @@
+// Copyright 2024 Jesus Bracho All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "RTSCameraReplicator.generated.h"
+
+class FBitReader;
+class FBitWriter;
+class USpringArmComponent;
+
+/** What a RTS camera rig looks at, in world units */
+USTRUCT(BlueprintType)
+struct FRTSCameraViewState
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "RTSCamera|Replication")
+	FVector Location = FVector::ZeroVector;
+
+	UPROPERTY(BlueprintReadOnly, Category = "RTSCamera|Replication")
+	float Yaw = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "RTSCamera|Replication")
+	float Pitch = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "RTSCamera|Replication")
+	float Zoom = 0;
+};
+
+/** FRTSCameraViewState snapped to the grid used on the wire */
+USTRUCT()
+struct OPENRTSCAMERA_API FRTSQuantizedCameraState
+{
+	GENERATED_BODY()
+
+	FIntVector Position = FIntVector::ZeroValue;
+	uint32 Yaw = 0;
+	uint32 Pitch = 0;
+	uint32 Zoom = 0;
+
+	/** Absolute encoding, used for keyframes and for the state replicated to spectators */
+	bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess);
+
+	bool operator==(const FRTSQuantizedCameraState& Other) const
+	{
+		return Position == Other.Position && Yaw == Other.Yaw && Pitch == Other.Pitch && Zoom == Other.Zoom;
+	}
+	bool operator!=(const FRTSQuantizedCameraState& Other) const { return !(*this == Other); }
+};
+
+template<>
+struct TStructOpsTypeTraits<FRTSQuantizedCameraState> : public TStructOpsTypeTraitsBase2<FRTSQuantizedCameraState>
+{
+	enum
+	{
+		WithNetSerializer = true,
+		WithIdenticalViaEquality = true,
+	};
+};
+
+/**
+ * Quantization and delta encoding used by URTSCameraReplicator.
+ * Has no UObject dependencies so it can be exercised headless.
+ */
+struct OPENRTSCAMERA_API FRTSCameraStateCodec
+{
+	/** cm per quantization step for the root position */
+	static constexpr float PositionPrecision = 10.0f;
+
+	/** cm per quantization step for the arm length */
+	static constexpr float ZoomPrecision = 10.0f;
+
+	static constexpr uint32 YawSteps = 1 << 12;
+	static constexpr uint32 PitchSteps = 1 << 10;
+
+	static FRTSQuantizedCameraState Quantize(const FRTSCameraViewState& State);
+	static FRTSCameraViewState Dequantize(const FRTSQuantizedCameraState& State);
+
+	/** Writes only the fields that differ from the baseline, as zigzag varints behind a one bit "changed" flag */
+	static void WriteDelta(FBitWriter& Writer, const FRTSQuantizedCameraState& Baseline, const FRTSQuantizedCameraState& State);
+	static bool ReadDelta(FBitReader& Reader, const FRTSQuantizedCameraState& Baseline, FRTSQuantizedCameraState& OutState);
+};
+
+/**
+ * Optional component for the camera pawn that lets casters and spectators see what each player's camera sees.
+ * The owning client sends quantized deltas against its last keyframe at a rate that follows how fast the camera moves,
+ * the server republishes the state to everybody else, and remote copies interpolate between the received states and
+ * drive the rig so it can be used as a view target.
+ * The owning actor has to replicate.
+ */
+UCLASS(Blueprintable, ClassGroup=(Custom), meta=(BlueprintSpawnableComponent))
+class OPENRTSCAMERA_API URTSCameraReplicator : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	URTSCameraReplicator();
+
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	/** Send rate while the camera is barely moving, in updates per second */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera|Replication", meta = (ClampMin = "0.1"))
+	float MinSendRate;
+
+	/** Send rate while the camera moves at FullRateSpeed or faster */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera|Replication", meta = (ClampMin = "0.1"))
+	float MaxSendRate;
+
+	/** Camera speed, in cm/s, at which we send at MaxSendRate */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera|Replication")
+	float FullRateSpeed;
+
+	/** Seconds between two reliable keyframes, deltas are always encoded against the latest one */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera|Replication")
+	float KeyframeInterval;
+
+	/** How far behind the latest received state remote copies render, should cover at least one send interval */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera|Replication")
+	float InterpolationDelay;
+
+	/** Move the rig of remote copies to the replicated state so spectators can use it as view target */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera|Replication")
+	bool bDriveRemoteRig;
+
+	/** Latest state: captured on the owner, received on the server, interpolated on remote copies */
+	UFUNCTION(BlueprintPure, Category = "RTSCamera|Replication")
+	FRTSCameraViewState GetViewState() const { return ViewState; }
+
+	/** Bytes per second sent by the owner, received by the server or received by a remote copy, averaged over a second */
+	UFUNCTION(BlueprintPure, Category = "RTSCamera|Replication")
+	float GetBytesPerSecond() const { return BytesPerSecond; }
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	UFUNCTION(Server, Reliable)
+	void ServerReceiveKeyframe(uint8 KeyframeId, const FRTSQuantizedCameraState& State);
+
+	UFUNCTION(Server, Unreliable)
+	void ServerReceiveDelta(uint8 KeyframeId, const TArray<uint8>& Payload);
+
+	UFUNCTION()
+	void OnRep_ReplicatedState();
+
+	UPROPERTY(ReplicatedUsing = OnRep_ReplicatedState)
+	FRTSQuantizedCameraState ReplicatedState;
+
+private:
+	struct FSnapshot
+	{
+		double Time = 0;
+		FRTSCameraViewState State;
+	};
+
+	bool IsLocallyOwned() const;
+	FRTSCameraViewState CaptureViewState() const;
+	void ConditionallySendState();
+	void SendKeyframe(const FRTSQuantizedCameraState& State, double Now);
+	void SetServerState(const FRTSQuantizedCameraState& State);
+	void InterpolateRemoteState();
+	void ApplyViewStateToRig() const;
+	void CountBytes(int32 NumBytes);
+
+	UPROPERTY()
+	USceneComponent* Root;
+
+	UPROPERTY()
+	USpringArmComponent* SpringArm;
+
+	FRTSCameraViewState ViewState;
+	FRTSQuantizedCameraState Keyframe;
+	FRTSQuantizedCameraState LastSentState;
+	TArray<FSnapshot> Snapshots;
+
+	double LastSendTime = 0;
+	double LastKeyframeTime = 0;
+	double BytesWindowStart = 0;
+	int32 BytesInWindow = 0;
+	float BytesPerSecond = 0;
+	uint8 KeyframeId = 0;
+	bool bHasKeyframe = false;
+};
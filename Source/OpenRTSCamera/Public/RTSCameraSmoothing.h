@@ -0,0 +1,84 @@
+// Copyright 2024 Jesus Bracho All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RTSCameraSmoothing.generated.h"
+
+UENUM(BlueprintType)
+enum class ERTSCameraSmoothingMode : uint8
+{
+	/** Closes the same fraction of the gap per second whatever the frame rate, starts moving at full speed */
+	ExponentialDecay,
+	/** Critically damped spring, eases in and out and never overshoots */
+	CriticallyDampedSpring,
+};
+
+/**
+ * One smoothed camera quantity (zoom, height, yaw...). Both modes are solved exactly for a fixed target, so advancing
+ * once by 1/30 s or eight times by 1/240 s lands on the same value. When the target moves during a long frame the
+ * step is split into sub-steps that follow the target linearly, so hitches do not cut corners either.
+ * Has no UObject dependencies so it can be exercised headless.
+ */
+template <typename T>
+struct TRTSSmoothedChannel
+{
+	/** Longest step solved in one go when the target moved since the last advance, in seconds */
+	static constexpr float MaxSubstep = 1.0f / 30.0f;
+
+	/** Hitches longer than MaxSubstep * MaxSubsteps are solved in MaxSubsteps steps */
+	static constexpr int32 MaxSubsteps = 16;
+
+	/** @param Speed - Like the speed of FMath::FInterpTo, the inverse of the time constant. 0 or less snaps to the target
+	 * @return The new value */
+	T Advance(const T& Current, const T& Target, const float Speed, const float DeltaTime, const ERTSCameraSmoothingMode Mode)
+	{
+		if (Speed <= 0)
+		{
+			Reset(Target);
+			return Target;
+		}
+		if (DeltaTime <= 0)
+		{
+			return Current;
+		}
+
+		const T StartTarget = bHasPreviousTarget ? PreviousTarget : Target;
+		const int32 NumSteps = StartTarget == Target ? 1 : FMath::Clamp(FMath::CeilToInt32(DeltaTime / MaxSubstep), 1, MaxSubsteps);
+		const float Step = DeltaTime / NumSteps;
+		const float Decay = FMath::Exp(-Speed * Step);
+
+		T Value = Current;
+		for (int32 Index = 1; Index <= NumSteps; ++Index)
+		{
+			const T StepTarget = NumSteps == 1 ? Target : FMath::Lerp(StartTarget, Target, static_cast<float>(Index) / NumSteps);
+			const T Offset = Value - StepTarget;
+			if (Mode == ERTSCameraSmoothingMode::CriticallyDampedSpring)
+			{
+				const T Impulse = Velocity + Offset * Speed;
+				Value = StepTarget + (Offset + Impulse * Step) * Decay;
+				Velocity = (Velocity - Impulse * (Speed * Step)) * Decay;
+			}
+			else
+			{
+				Value = StepTarget + Offset * Decay;
+			}
+		}
+
+		PreviousTarget = Target;
+		bHasPreviousTarget = true;
+		return Value;
+	}
+
+	/** Forgets the velocity and the last target, for when the quantity was moved by something else */
+	void Reset(const T& Target)
+	{
+		Velocity = T(0);
+		PreviousTarget = Target;
+		bHasPreviousTarget = false;
+	}
+
+	T Velocity = T(0);
+	T PreviousTarget = T(0);
+	bool bHasPreviousTarget = false;
+};
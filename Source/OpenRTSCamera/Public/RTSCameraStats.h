@@ -0,0 +1,9 @@
+// Copyright 2024 Jesus Bracho All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+
+/** Shared stat group so every camera/selection stage shows up under `stat OpenRTSCamera` */
+DECLARE_STATS_GROUP(TEXT("OpenRTSCamera"), STATGROUP_OpenRTSCamera, STATCAT_Advanced);
@@ -0,0 +1,154 @@
+// Copyright 2024 Jesus Bracho All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineBaseTypes.h"
+#include "WorldCollision.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "RTSCameraSubsystem.generated.h"
+
+class APlayerController;
+class URTSCamera;
+class URTSCameraSubsystem;
+
+/** Mouse state of one player controller, captured once per frame and shared by every rig it drives */
+USTRUCT(BlueprintType)
+struct FRTSCameraInputSnapshot
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "RTSCamera")
+	FVector2D MousePosition = FVector2D::ZeroVector;
+
+	UPROPERTY(BlueprintReadOnly, Category = "RTSCamera")
+	FVector2D ViewportSize = FVector2D::ZeroVector;
+
+	/** False when the player has no mouse (gamepad, spectator without cursor...), edge scrolling and dragging are skipped */
+	UPROPERTY(BlueprintReadOnly, Category = "RTSCamera")
+	bool bHasMouse = false;
+};
+
+/** Where the cursor of a player meets the ground, computed once per frame and shared by every consumer */
+USTRUCT(BlueprintType)
+struct FRTSCursorGroundHit
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "RTSCamera")
+	FVector Location = FVector::ZeroVector;
+
+	UPROPERTY(BlueprintReadOnly, Category = "RTSCamera")
+	FVector RayOrigin = FVector::ZeroVector;
+
+	UPROPERTY(BlueprintReadOnly, Category = "RTSCamera")
+	FVector RayDirection = FVector::ForwardVector;
+
+	/** False when the cursor is off screen or does not point at any ground */
+	UPROPERTY(BlueprintReadOnly, Category = "RTSCamera")
+	bool bValid = false;
+
+	/** True if Location comes from an actual trace (one frame old), false if it was the last hit reprojected along the
+	 * current ray and refined from the height cache, without tracing */
+	UPROPERTY(BlueprintReadOnly, Category = "RTSCamera")
+	bool bFromTrace = false;
+};
+
+/** Runs the batched camera pass once units have moved and the selectable registry has synced their locations */
+struct FRTSCameraSubsystemTickFunction : public FTickFunction
+{
+	URTSCameraSubsystem* Subsystem = nullptr;
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+};
+
+/**
+ * Owns every active URTSCamera rig of the world (one per local player, spectator or observer) and updates them in a
+ * single pass. Input is sampled once per player controller and ground heights come from a shared grid cache, so
+ * extra rigs only pay for the traces of ground nobody else has looked at yet.
+ */
+UCLASS(Config=Game)
+class OPENRTSCAMERA_API URTSCameraSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	void RegisterCamera(URTSCamera* Camera);
+	void UnregisterCamera(URTSCamera* Camera);
+
+	UFUNCTION(BlueprintPure, Category = "RTSCamera")
+	TArray<URTSCamera*> GetCameras() const { return Cameras; }
+
+	/** @return The input captured this frame for the given player controller */
+	UFUNCTION(BlueprintPure, Category = "RTSCamera")
+	FRTSCameraInputSnapshot GetInputSnapshot(const APlayerController* PlayerController) const;
+
+	/** @return Where the cursor of the player meets the ground this frame, see RequestCursorTracking() for controllers without a rig */
+	UFUNCTION(BlueprintPure, Category = "RTSCamera")
+	FRTSCursorGroundHit GetCursorGroundHit(const APlayerController* PlayerController) const;
+
+	/** Compute the cursor ground hit for this controller even if it does not drive any camera rig */
+	void RequestCursorTracking(APlayerController* PlayerController);
+
+	/** Bilinearly interpolated ground height below the location, traced at most once per grid corner and cache lifetime
+	 * @return False if none of the surrounding corners hit the ground */
+	bool GetGroundHeight(const FVector& Location, float TraceLength, float& OutHeight);
+
+	/** Updates every registered rig, called by the tick function */
+	void TickCameras(float DeltaTime);
+
+	/** Add as a prerequisite to run after the rigs moved this frame */
+	FTickFunction& GetTickFunction() { return TickFunction; }
+
+	/** Size of a ground height cache cell, in cm */
+	UPROPERTY(Config)
+	float GroundHeightCellSize = 200.0f;
+
+	/** How long a cached ground height stays valid, in seconds */
+	UPROPERTY(Config)
+	float GroundHeightCacheLifetime = 5.0f;
+
+	/** Length of the cursor ray, in cm */
+	UPROPERTY(Config)
+	float CursorTraceLength = 100000.0f;
+
+private:
+	struct FGroundSample
+	{
+		float Height = 0;
+		double Time = 0;
+		bool bHit = false;
+	};
+
+	struct FCursorState
+	{
+		FTraceHandle PendingTrace;
+		FRTSCursorGroundHit Hit;
+	};
+
+	FGroundSample SampleGroundCorner(const FIntPoint& Corner, float StartZ, float TraceLength);
+	void CaptureInputSnapshots();
+	void CaptureInputSnapshot(const APlayerController* PlayerController);
+	void UpdateCursorGroundHits();
+	bool ApproximateCursorGroundHit(const FVector& RayOrigin, const FVector& RayDirection, float ReferenceZ, FVector& OutLocation) const;
+
+	/** Like GetGroundHeight() but only reads the cache, never traces */
+	bool GetCachedGroundHeight(const FVector& Location, float& OutHeight) const;
+	void PruneGroundCache();
+
+	UPROPERTY()
+	TArray<URTSCamera*> Cameras;
+
+	UPROPERTY()
+	TArray<APlayerController*> CursorTrackedControllers;
+
+	TMap<const APlayerController*, FRTSCameraInputSnapshot> InputSnapshots;
+	TMap<const APlayerController*, FCursorState> CursorStates;
+	TMap<FIntPoint, FGroundSample> GroundCache;
+	FRTSCameraSubsystemTickFunction TickFunction;
+	double LastGroundCachePruneTime = 0;
+};
@@ -0,0 +1,79 @@
+// Copyright 2024 Jesus Bracho All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RTSCameraTransition.generated.h"
+
+/** Shape of the trajectories URTSCamera::JumpTo() flies along */
+USTRUCT(BlueprintType)
+struct FRTSCameraTransitionSettings
+{
+	GENERATED_BODY()
+
+	/** Travel speed used to derive the duration from the distance, in cm/s */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera|Transition", meta = (ClampMin = "1.0"))
+	float Speed = 20000.0f;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera|Transition", meta = (ClampMin = "0.0"))
+	float MinDuration = 0.25f;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera|Transition", meta = (ClampMin = "0.0"))
+	float MaxDuration = 1.5f;
+
+	/** Height of the arc at the midpoint, relative to the travelled distance */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera|Transition", meta = (ClampMin = "0.0"))
+	float ArcHeightRatio = 0.05f;
+
+	/** Extra arm length at the midpoint, relative to the travelled distance, so long jumps zoom out then back in */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera|Transition", meta = (ClampMin = "0.0"))
+	float ZoomOutRatio = 0.15f;
+};
+
+/** Where the rig is, looks and how far it is zoomed out */
+USTRUCT(BlueprintType)
+struct FRTSCameraBookmark
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera|Bookmarks")
+	FVector Location = FVector::ZeroVector;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera|Bookmarks")
+	float Yaw = 0;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera|Bookmarks")
+	float Zoom = 0;
+};
+
+/**
+ * A camera flight between two rig states. Everything is resolved when it starts, afterwards each evaluation is a
+ * handful of multiply-adds: eased progress, a parabolic arc on top of the straight line, and a parabolic zoom bump.
+ * Has no UObject dependencies so it can be exercised headless.
+ */
+struct OPENRTSCAMERA_API FRTSCameraTransition
+{
+	/** @param MaxZoom - Upper bound for the zoom bump, usually the rig's maximum zoom length */
+	void Start(const FRTSCameraBookmark& From, const FRTSCameraBookmark& To, const FRTSCameraTransitionSettings& Settings, float MaxZoom);
+
+	void Cancel() { bActive = false; }
+
+	bool IsActive() const { return bActive; }
+
+	float GetDuration() const { return Duration; }
+
+	/** Moves the transition forward and writes the state to apply to the rig
+	 * @return False once the transition reached its end, the output then is the exact destination */
+	bool Advance(float DeltaTime, FRTSCameraBookmark& OutState);
+
+private:
+	FRTSCameraBookmark From;
+	FVector Delta = FVector::ZeroVector;
+	float DeltaYaw = 0;
+	float DeltaZoom = 0;
+	float ArcHeight = 0;
+	float ZoomBump = 0;
+	float Duration = 0;
+	float Elapsed = 0;
+	bool bActive = false;
+};
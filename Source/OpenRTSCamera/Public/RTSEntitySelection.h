@@ -0,0 +1,111 @@
+// Copyright 2024 Jesus Bracho All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "RTSEntitySelection.generated.h"
+
+class UInstancedStaticMeshComponent;
+
+/** Lightweight reference to a selectable unit that is not an actor (mass entity, mesh instance...) */
+USTRUCT(BlueprintType)
+struct FRTSEntityHandle
+{
+	GENERATED_BODY()
+
+	/** Which URTSEntitySelectionSource of the URTSSelectableRegistry the entity comes from */
+	UPROPERTY(BlueprintReadOnly, Category = "RTSCamera - Selection")
+	int32 SourceId = INDEX_NONE;
+
+	/** Index of the entity inside its source */
+	UPROPERTY(BlueprintReadOnly, Category = "RTSCamera - Selection")
+	int32 Index = INDEX_NONE;
+
+	/** Generation of the source when the handle was made, lets sources detect handles that outlived their entity */
+	UPROPERTY(BlueprintReadOnly, Category = "RTSCamera - Selection")
+	int32 Serial = 0;
+
+	bool operator==(const FRTSEntityHandle& Other) const
+	{
+		return SourceId == Other.SourceId && Index == Other.Index && Serial == Other.Serial;
+	}
+
+	bool operator<(const FRTSEntityHandle& Other) const
+	{
+		if (SourceId != Other.SourceId)
+		{
+			return SourceId < Other.SourceId;
+		}
+		return Index != Other.Index ? Index < Other.Index : Serial < Other.Serial;
+	}
+};
+
+/** Selection candidates of one source, in SoA form so the screen space query walks contiguous memory */
+struct FRTSEntityCandidates
+{
+	TArray<FVector> Locations;
+	TArray<float> BoundsRadii;
+	TArray<int32> Indices;
+
+	void Reset()
+	{
+		Locations.Reset();
+		BoundsRadii.Reset();
+		Indices.Reset();
+	}
+
+	void Add(const FVector& Location, const float BoundsRadius, const int32 Index)
+	{
+		Locations.Add(Location);
+		BoundsRadii.Add(BoundsRadius);
+		Indices.Add(Index);
+	}
+};
+
+/**
+ * Feeds selectable units that are not actors to URTSSelector.
+ * Subclass it to expose a Mass query (transform fragment + your selectable tag) or any other custom storage,
+ * then register it with URTSSelectableRegistry::RegisterEntitySource().
+ */
+UCLASS(Abstract)
+class OPENRTSCAMERA_API URTSEntitySelectionSource : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	/** Appends every selectable entity to the candidates, called on the game thread once per selection query */
+	virtual void GatherCandidates(FRTSEntityCandidates& OutCandidates) const PURE_VIRTUAL(URTSEntitySelectionSource::GatherCandidates, );
+
+	/** Bumped whenever indices get reused, stored in the handles */
+	virtual int32 GetGeneration() const { return 0; }
+
+	/** Called once per selection change with the entities of this source that were added to or removed from the selection */
+	virtual void OnEntitySelectionChanged(TConstArrayView<FRTSEntityHandle> Selected, TConstArrayView<FRTSEntityHandle> Deselected) {}
+};
+
+/** Makes every instance of an (hierarchical) instanced static mesh component selectable */
+UCLASS(BlueprintType)
+class OPENRTSCAMERA_API URTSInstancedMeshSelectionSource : public URTSEntitySelectionSource
+{
+	GENERATED_BODY()
+
+public:
+	/** Creates a source for the component and registers it with the registry of the component's world */
+	UFUNCTION(BlueprintCallable, Category = "RTSCamera - Selection")
+	static URTSInstancedMeshSelectionSource* RegisterInstancedMesh(UInstancedStaticMeshComponent* InComponent);
+
+	virtual void GatherCandidates(FRTSEntityCandidates& OutCandidates) const override;
+	virtual int32 GetGeneration() const override { return Generation; }
+
+	/** Call after adding, removing or reordering instances of the component, instances are addressed by index
+	 * so the handles made before stop matching the selection */
+	UFUNCTION(BlueprintCallable, Category = "RTSCamera - Selection")
+	void OnInstancesChanged() { ++Generation; }
+
+	UPROPERTY(BlueprintReadOnly, Category = "RTSCamera - Selection")
+	UInstancedStaticMeshComponent* Component;
+
+private:
+	int32 Generation = 0;
+};
@@ -0,0 +1,50 @@
+// Copyright 2024 Jesus Bracho All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Centroid, spread and bounds of a group of moving points, kept up to date from the moves themselves: every member only
+ * contributes its running sums and can only grow the bounds, so following a group costs O(1) per member that actually moved.
+ * The sums and bounds are rebuilt from the members by Refresh() when the membership changed, when a member that defined
+ * the bounds moved inward, and after as many moves as there are members so rounding never builds up.
+ * Has no UObject dependencies so it can be exercised headless.
+ */
+struct OPENRTSCAMERA_API FRTSFollowGroup
+{
+	void Reset();
+
+	void Add(const void* Key, const FVector& Location);
+	void Move(const void* Key, const FVector& Location);
+	void Remove(const void* Key);
+
+	/** Rebuilds the sums and bounds from the members if they went stale, call once before reading the group */
+	void Refresh();
+
+	int32 Num() const { return Locations.Num(); }
+	bool Contains(const void* Key) const { return Locations.Contains(Key); }
+
+	FVector GetCentroid() const { return Num() > 0 ? Sum / Num() : FVector::ZeroVector; }
+
+	/** Root mean square distance of the members to the centroid. A group spread evenly over a disc of radius R has a
+	 * spread of R / sqrt(2), scale accordingly when framing */
+	float GetSpreadRadius() const;
+
+	/** Box around every member as of the last Refresh() */
+	const FBox& GetBounds() const { return Bounds; }
+
+	/** Horizontal distance from the centroid to the farthest corner of the bounds, a circle of that radius around the
+	 * centroid contains every member including stragglers. As of the last Refresh() */
+	float GetExtentRadius() const;
+
+private:
+	TMap<const void*, FVector> Locations;
+	FVector Sum = FVector::ZeroVector;
+	double SumOfSquares = 0;
+	FBox Bounds = FBox(ForceInit);
+
+	/** Set when the sums or the bounds have to be rebuilt from the members */
+	bool bStale = false;
+	int32 NumMovesSinceRefresh = 0;
+};
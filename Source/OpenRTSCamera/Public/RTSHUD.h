@@ -3,6 +3,7 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "CanvasItem.h"
 #include "GameFramework/HUD.h"
 #include "RTSHUD.generated.h"
 
@@ -20,6 +21,31 @@ public:
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Selection Box")
 	float SelectionBoxThickness;
 
+	/** Fill the inside of the selection box, drawn in the same batch as its outline */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Selection Box")
+	bool bFillSelectionBox;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Selection Box", meta = (EditCondition = "bFillSelectionBox"))
+	FLinearColor SelectionBoxFillColor;
+
+	/** Pre-selection: while the box is dragged, draw corner brackets around every unit it would select.
+	 * Only drawn while release selects registered units through the registry, not while clustering or when the selector
+	 * falls back to the actor query, so the brackets always match the selection. They go in the same batch as the box */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Selection Box")
+	bool bHighlightUnitsInSelectionBox;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Selection Box", meta = (EditCondition = "bHighlightUnitsInSelectionBox"))
+	FLinearColor HighlightBracketColor;
+
+	/** Length of each bracket arm, as a fraction of the unit's projected size */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Selection Box", meta = (EditCondition = "bHighlightUnitsInSelectionBox", ClampMin = "0.0", ClampMax = "0.5"))
+	float HighlightBracketLength;
+
+	/** Seconds between two queries of the units under the dragged box, the brackets follow the box and the units at that rate.
+	 * 0 queries every frame */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Selection Box", meta = (EditCondition = "bHighlightUnitsInSelectionBox", ClampMin = "0.0", Units = "s"))
+	float HighlightQueryInterval;
+
 	UFUNCTION(BlueprintCallable, Category = "Selection Box")
 	void BeginSelection(const FVector2D& StartPoint);
 
@@ -29,6 +55,10 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Selection Box")
 	void EndSelection();
 
+	/** Stops drawing the selection box without performing a box selection, used when the drag turned out to be a click */
+	UFUNCTION(BlueprintCallable, Category = "Selection Box")
+	void CancelSelection();
+
 	UFUNCTION(BlueprintNativeEvent, Category = "Selection Box")
 	void DrawSelectionBox(const FVector2D& StartPoint, const FVector2D& EndPoint);
 
@@ -43,4 +73,27 @@ private:
 	bool bIsPerformingSelection;
 	FVector2D SelectionStart;
 	FVector2D SelectionEnd;
+
+	/** Box and fill triangles, only rebuilt when the box or the style changed since the last frame */
+	TUniquePtr<FCanvasTriangleItem> SelectionBoxItem;
+
+	/** Bracket triangles, only rebuilt when a query found other units or other bounds. Drawn right after the box so
+	 * both land in the same batch */
+	TUniquePtr<FCanvasTriangleItem> HighlightItem;
+
+	/** What the items were last built from */
+	FBox2D BuiltSelectionBox = FBox2D(ForceInit);
+	TArray<FBox2D> BuiltHighlightBounds;
+	uint32 BuiltStyleHash = 0;
+
+	/** Real time of the last query of the units under the box, reset when a new box starts */
+	double LastHighlightQuerySeconds = TNumericLimits<double>::Lowest();
+
+	/** Scratch buffer for the units under the box */
+	TArray<FBox2D> HighlightBounds;
+
+	uint32 GetSelectionBoxStyleHash() const;
+	bool QueryHighlightBounds(const FBox2D& Box);
+	void BuildSelectionBoxTriangles(const FBox2D& Box);
+	void BuildHighlightTriangles();
 };
@@ -0,0 +1,199 @@
+// Copyright 2024 Jesus Bracho All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "RTSMinimap.generated.h"
+
+class URTSCamera;
+class URTSCameraSubsystem;
+class URTSSelectableRegistry;
+class UTexture2D;
+
+/** What the minimap shows on top of the units, in minimap pixels */
+struct FRTSMinimapOverlay
+{
+	/** Ground footprint of each camera rig, four corners in drawing order */
+	TArray<TStaticArray<FVector2D, 4>> CameraFootprints;
+};
+
+/**
+ * Square CPU pixel buffer covering a world rectangle, split in tiles. Every rasterization bins the units per tile and
+ * only redraws, in parallel, the tiles whose units or overlay changed since the last one.
+ * Pixel rows go from +X (top) to -X, columns from -Y (left) to +Y, so the top of the minimap is world forward.
+ * Has no UObject dependencies so it can be exercised headless.
+ */
+class OPENRTSCAMERA_API FRTSMinimapRaster
+{
+public:
+	struct FStyle
+	{
+		FColor InsideBoundsColor = FColor(24, 32, 24);
+		FColor OutsideBoundsColor = FColor(8, 8, 8);
+		FColor BoundsOutlineColor = FColor(96, 96, 96);
+		FColor FootprintColor = FColor::White;
+		/** Indexed by team, teams past the end use the last color */
+		TArray<FColor> TeamColors = {FColor::Green, FColor::Red, FColor::Blue, FColor::Yellow};
+		/** Side of the square drawn for each unit, in pixels */
+		int32 UnitSize = 2;
+	};
+
+	/** Clears the buffer and marks every tile dirty
+	 * @param InBounds - Area inside the camera bounds, the minimap covers the square around it grown by BoundsMargin
+	 * @param BoundsMargin - Extra area shown around the bounds, relative to their size */
+	void Initialize(const FBox2D& InBounds, float BoundsMargin, int32 InSize, int32 InTileSize, const FStyle& InStyle);
+
+	bool IsInitialized() const { return Size > 0; }
+
+	/** Redraws the tiles that changed
+	 * @param Locations - World locations of the units, only X and Y are used
+	 * @param Teams - Team of each unit, same length as Locations
+	 * @return How many tiles were redrawn */
+	int32 Rasterize(TConstArrayView<FVector> Locations, TConstArrayView<uint8> Teams, const FRTSMinimapOverlay& Overlay);
+
+	FVector2D WorldToPixel(const FVector& Location) const;
+	FVector2D PixelToWorld(const FVector2D& Pixel) const;
+
+	/** Row major, Size * Size pixels */
+	const TArray<FColor>& GetPixels() const { return Pixels; }
+
+	FColor GetPixel(const int32 X, const int32 Y) const { return Pixels[Y * Size + X]; }
+
+	/** Pixel rectangle of every tile redrawn by the last Rasterize() */
+	const TArray<FIntRect>& GetRedrawnTiles() const { return RedrawnTiles; }
+
+	int32 GetSize() const { return Size; }
+
+private:
+	struct FUnitPixel
+	{
+		int32 X;
+		int32 Y;
+		uint8 Team;
+	};
+
+	FIntRect GetTileRect(int32 Tile) const;
+	void DrawTile(int32 Tile, const FRTSMinimapOverlay& Overlay);
+
+	FStyle Style;
+	FVector2D Origin = FVector2D::ZeroVector;
+	double PixelsPerUnit = 1;
+	int32 Size = 0;
+	int32 TileSize = 1;
+	int32 NumTilesPerSide = 0;
+
+	TArray<FColor> Pixels;
+
+	/** What a tile looks like without units and overlay, the bounds area and its outline */
+	TArray<FColor> Background;
+
+	/** Units binned per tile by a counting sort, a unit whose square straddles tiles is in each of them */
+	TArray<int32> TileStarts;
+	TArray<FUnitPixel> TileUnits;
+
+	/** Scratch buffers of the binning pass */
+	TArray<FUnitPixel> UnitPixels;
+	TArray<int32> TileCursors;
+
+	/** Hash of what was drawn into each tile, a tile is redrawn when its new hash differs */
+	TArray<uint32> TileHashes;
+	TArray<uint32> NewTileHashes;
+	TArray<int32> DirtyTiles;
+	TArray<FIntRect> RedrawnTiles;
+	bool bAllTilesDirty = true;
+};
+
+/**
+ * Minimap data provider. Rasterizes the registry's units by team, the ground footprint of every local camera rig and
+ * the camera bounds volume into a small pixel buffer at a fixed rate, and mirrors the redrawn tiles into a transient
+ * texture for the UI. Minimap clicks go through URTSCamera::JumpTo so they respect the camera bounds.
+ */
+UCLASS(Config=Game)
+class OPENRTSCAMERA_API URTSMinimapSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/** Starts or stops the periodic updates, the minimap costs nothing until it is enabled */
+	UFUNCTION(BlueprintCallable, Category = "RTSCamera - Minimap")
+	void SetMinimapEnabled(bool bEnabled);
+
+	/** Tells the minimap which team a unit belongs to, every unit is on team 0 until a resolver is set */
+	void SetTeamResolver(TFunction<uint8(const AActor*)> InTeamResolver);
+
+	/** Redraws right away instead of waiting for the next update */
+	UFUNCTION(BlueprintCallable, Category = "RTSCamera - Minimap")
+	void UpdateMinimap();
+
+	/** Updated with the redrawn tiles only, null until the first update */
+	UFUNCTION(BlueprintPure, Category = "RTSCamera - Minimap")
+	UTexture2D* GetMinimapTexture() const { return Texture; }
+
+	/** @param MinimapPosition - From 0 to 1 across the minimap, (0, 0) is the top left corner */
+	UFUNCTION(BlueprintPure, Category = "RTSCamera - Minimap")
+	FVector MinimapToWorld(const FVector2D& MinimapPosition) const;
+
+	UFUNCTION(BlueprintPure, Category = "RTSCamera - Minimap")
+	FVector2D WorldToMinimap(const FVector& Location) const;
+
+	/** Flies the camera to the point under a minimap click, clamped to the camera bounds like any other jump
+	 * @return False if the minimap is not ready or the position is off the minimap */
+	UFUNCTION(BlueprintCallable, Category = "RTSCamera - Minimap")
+	bool JumpToMinimapPosition(URTSCamera* Camera, const FVector2D& MinimapPosition) const;
+
+	const FRTSMinimapRaster& GetRaster() const { return Raster; }
+
+	/** Width and height of the minimap, in pixels */
+	UPROPERTY(Config)
+	int32 Resolution = 256;
+
+	/** Side of a tile, the unit of redraw and of parallel work, in pixels */
+	UPROPERTY(Config)
+	int32 TileSize = 32;
+
+	/** Seconds between two updates, 0 updates every frame */
+	UPROPERTY(Config)
+	float UpdateInterval = 0.1f;
+
+	/** Extra area shown around the camera bounds, relative to their size */
+	UPROPERTY(Config)
+	float BoundsMargin = 0.05f;
+
+	/** Side of the square drawn for each unit, in pixels */
+	UPROPERTY(Config)
+	int32 UnitPixelSize = 2;
+
+	/** Indexed by team, teams past the end use the last color */
+	UPROPERTY(Config)
+	TArray<FColor> TeamColors = {FColor::Green, FColor::Red, FColor::Blue, FColor::Yellow};
+
+	/** Footprint corners that look above the horizon are drawn this far from the camera, in cm */
+	UPROPERTY(Config)
+	float MaxFootprintDistance = 50000.0f;
+
+private:
+	bool EnsureInitialized();
+	void GatherCameraFootprints();
+	void UploadRedrawnTiles();
+
+	UPROPERTY()
+	URTSSelectableRegistry* Registry;
+
+	UPROPERTY()
+	URTSCameraSubsystem* CameraSubsystem;
+
+	UPROPERTY()
+	UTexture2D* Texture;
+
+	FRTSMinimapRaster Raster;
+	FRTSMinimapOverlay Overlay;
+	TFunction<uint8(const AActor*)> TeamResolver;
+	TArray<uint8> Teams;
+	float TimeSinceUpdate = 0;
+	bool bMinimapEnabled = false;
+};
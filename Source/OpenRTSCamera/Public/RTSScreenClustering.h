@@ -0,0 +1,74 @@
+// Copyright 2024 Jesus Bracho All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RTSScreenClustering.generated.h"
+
+struct FRTSScreenProjector;
+struct FRTSVisibilityGrid;
+
+/** Units that project into the same screen cell, handled as one when the camera is zoomed far out */
+USTRUCT(BlueprintType)
+struct FRTSScreenCluster
+{
+	GENERATED_BODY()
+
+	/** Average viewport position of the members, in pixels */
+	UPROPERTY(BlueprintReadOnly, Category = "RTSCamera - Selection")
+	FVector2D ScreenCenter = FVector2D::ZeroVector;
+
+	UPROPERTY(BlueprintReadOnly, Category = "RTSCamera - Selection")
+	FVector WorldCenter = FVector::ZeroVector;
+
+	/** Distance in pixels from the center to the farthest member */
+	UPROPERTY(BlueprintReadOnly, Category = "RTSCamera - Selection")
+	float ScreenRadius = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "RTSCamera - Selection")
+	int32 NumMembers = 0;
+
+	/** Where the members start in FRTSScreenClusterGrid::GetMembers() */
+	int32 FirstMember = 0;
+};
+
+/**
+ * Hashes projected points into a screen space grid, one cluster per occupied cell.
+ * Building is two linear passes, so queries afterwards cost per cluster rather than per unit.
+ */
+class OPENRTSCAMERA_API FRTSScreenClusterGrid
+{
+public:
+	/** Clusters every point that lands on screen, indices of the members are indices into Locations
+	 * @param VisibilityGrid - Optional, points in hidden cells are skipped before being projected */
+	void Build(const FRTSScreenProjector& Projector, TConstArrayView<FVector> Locations, float InCellSize, const FRTSVisibilityGrid* VisibilityGrid = nullptr);
+
+	const TArray<FRTSScreenCluster>& GetClusters() const { return Clusters; }
+
+	TConstArrayView<int32> GetMembers(const int32 Cluster) const
+	{
+		return TConstArrayView<int32>(Members.GetData() + Clusters[Cluster].FirstMember, Clusters[Cluster].NumMembers);
+	}
+
+	/** @return The cluster whose cell contains the position, or INDEX_NONE */
+	int32 FindClusterAt(const FVector2D& ScreenPosition) const;
+
+	/** @return The cluster of the point at the given index of the last build, or INDEX_NONE if it was off screen */
+	int32 GetClusterOf(const int32 Index) const { return ClusterByIndex.IsValidIndex(Index) ? ClusterByIndex[Index] : INDEX_NONE; }
+
+	/** Frame the grid was last built in, lets callers share one build per frame */
+	uint64 BuildFrame = MAX_uint64;
+
+private:
+	FIntPoint GetCell(const FVector2D& ScreenPosition) const
+	{
+		return FIntPoint(FMath::FloorToInt32(ScreenPosition.X / CellSize), FMath::FloorToInt32(ScreenPosition.Y / CellSize));
+	}
+
+	float CellSize = 1;
+	TMap<FIntPoint, int32> ClusterByCell;
+	TArray<FRTSScreenCluster> Clusters;
+	TArray<int32> Members;
+	TArray<int32> ClusterByIndex;
+	TArray<FVector2D> ScreenPositions;
+};
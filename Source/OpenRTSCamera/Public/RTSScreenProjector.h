@@ -0,0 +1,65 @@
+// Copyright 2024 Jesus Bracho All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class APlayerController;
+
+/**
+ * Snapshot of a player's view, taken once per query so that thousands of points can be projected to viewport pixels
+ * with a single matrix multiply each instead of going through UGameplayStatics::ProjectWorldToScreen.
+ */
+struct OPENRTSCAMERA_API FRTSScreenProjector
+{
+	/** @return False if the controller has no local player or viewport to project with */
+	bool Initialize(const APlayerController* PlayerController);
+
+	/** Projects to viewport pixels, same space as the mouse position and the HUD canvas
+	 * @return False if the point is behind the camera */
+	bool Project(const FVector& WorldLocation, FVector2D& OutScreenPosition, double& OutDepth) const
+	{
+		const FVector4 Clip = ViewProjection.TransformFVector4(FVector4(WorldLocation, 1.0));
+		if (Clip.W <= UE_KINDA_SMALL_NUMBER)
+		{
+			return false;
+		}
+
+		const double InvW = 1.0 / Clip.W;
+		OutScreenPosition.X = ViewRect.Min.X + (0.5 + Clip.X * InvW * 0.5) * ViewRect.Width();
+		OutScreenPosition.Y = ViewRect.Min.Y + (0.5 - Clip.Y * InvW * 0.5) * ViewRect.Height();
+		OutDepth = Clip.W;
+		return true;
+	}
+
+	/** Size in pixels of a sphere of the given radius at the given depth */
+	float ProjectRadius(const float Radius, const double Depth) const
+	{
+		return static_cast<float>(Radius * PixelsPerUnitAtUnitDepth / Depth);
+	}
+
+	/** Inverse of Project() at a device depth. Depth is reversed, 1 is the near plane and it shrinks toward 0 with distance */
+	FVector Deproject(const FVector2D& ScreenPosition, double DeviceZ) const;
+
+	/** Where the view ray through the pixel meets the horizontal plane at the given height
+	 * @return False if the ray does not point down at the plane */
+	bool DeprojectToHeight(const FVector2D& ScreenPosition, double Height, FVector& OutLocation) const;
+
+	/** The ground the view covers: where its four corners meet the horizontal plane at the given height, clockwise from
+	 * the top left. Corners that look above the horizon or meet the plane further than MaxDistance from the view origin
+	 * are put MaxDistance away in their direction */
+	void DeprojectViewToHeight(double Height, double MaxDistance, FVector (&OutCorners)[4]) const;
+
+	bool IsOnScreen(const FVector2D& ScreenPosition, const float Margin = 0) const
+	{
+		return ScreenPosition.X >= ViewRect.Min.X - Margin && ScreenPosition.X <= ViewRect.Max.X + Margin
+			&& ScreenPosition.Y >= ViewRect.Min.Y - Margin && ScreenPosition.Y <= ViewRect.Max.Y + Margin;
+	}
+
+	FMatrix ViewProjection = FMatrix::Identity;
+	FMatrix InvViewProjection = FMatrix::Identity;
+	FMatrix Projection = FMatrix::Identity;
+	FVector ViewOrigin = FVector::ZeroVector;
+	FIntRect ViewRect;
+	double PixelsPerUnitAtUnitDepth = 1.0;
+};
@@ -1,14 +1,36 @@
 ﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
 #include "RTSSelectable.generated.h"
 
+/**
+ * Registers its owner with the URTSSelectableRegistry of the world for as long as it is in play.
+ * On the server it also gets a network id, which is what replicated selections refer to.
+ */
 UCLASS(Blueprintable, ClassGroup=(Custom), meta=(BlueprintSpawnableComponent))
 class OPENRTSCAMERA_API URTSSelectable : public UActorComponent
 {
 	GENERATED_BODY()
 public:
+	URTSSelectable();
+
 	UFUNCTION(BlueprintCallable, BlueprintImplementableEvent, Category = "RTS Selection")
 	void OnSelected();
 
 	UFUNCTION(BlueprintCallable, BlueprintImplementableEvent, Category = "RTS Selection")
 	void OnDeselected();
+
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	/** Compact id handed out by the server registry, INDEX_NONE until assigned */
+	UPROPERTY(ReplicatedUsing = OnRep_SelectableNetId, BlueprintReadOnly, Category = "RTS Selection")
+	int32 SelectableNetId = INDEX_NONE;
+
+protected:
+	UFUNCTION()
+	void OnRep_SelectableNetId();
+
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 };
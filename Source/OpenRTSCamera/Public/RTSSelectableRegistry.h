@@ -0,0 +1,229 @@
+// Copyright 2024 Jesus Bracho All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RTSSelectionRules.h"
+#include "Engine/EngineBaseTypes.h"
+#include "Interfaces/RTSBatchedSelection.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "RTSSelectableRegistry.generated.h"
+
+class URTSEntitySelectionSource;
+class URTSSelectableRegistry;
+class USceneComponent;
+enum class EUpdateTransformFlags : int32;
+enum class ETeleportType : uint8;
+
+/** Syncs the registry with the units that moved, after movement and before the camera rigs */
+struct FRTSSelectableRegistryTickFunction : public FTickFunction
+{
+	URTSSelectableRegistry* Registry = nullptr;
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+};
+
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnSelectableRegistryChanged, AActor* /* Actor */, int32 /* Slot */);
+
+/**
+ * Keeps every selectable unit of a world in packed arrays (one slot per unit) so camera and selection
+ * features can walk positions and bounds without touching the actors themselves.
+ * Slots are dense: unregistering swaps the last slot into the freed one, so never hold on to a slot across frames.
+ * Units flag their slot and capture their location on the game thread when their root component moves, only flagged
+ * slots are copied over, in parallel chunks, once per frame in TG_DuringPhysics (and on demand by queries that run
+ * earlier in the frame). The parallel copy never touches an actor.
+ */
+UCLASS()
+class OPENRTSCAMERA_API URTSSelectableRegistry : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Sentinel stored in the significance column for units that have not been bucketed yet */
+	static constexpr uint8 UnassignedSignificance = MAX_uint8;
+
+	/** Network ids are bit indices of replicated selections, this bounds the size of those bitsets */
+	static constexpr int32 MaxNetIds = 1 << 16;
+
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	/** Adds the actor to the registry, does nothing if it is already registered */
+	UFUNCTION(BlueprintCallable, Category = "RTSCamera - Selection")
+	void RegisterSelectable(AActor* Actor);
+
+	/** Removes the actor from the registry, does nothing if it is not registered */
+	UFUNCTION(BlueprintCallable, Category = "RTSCamera - Selection")
+	void UnregisterSelectable(AActor* Actor);
+
+	UFUNCTION(BlueprintPure, Category = "RTSCamera - Selection")
+	int32 GetNumSelectables() const { return Actors.Num(); }
+
+	/** @return The slot of the actor or INDEX_NONE if it is not registered */
+	int32 FindSlot(const AActor* Actor) const;
+
+	AActor* GetActor(const int32 Slot) const { return Actors[Slot]; }
+
+	/** Re-reads the location of the unit in the given slot from its actor, game thread only */
+	void RefreshSlot(int32 Slot);
+
+	/** Updates the locations of the units that moved since the last sync, cheap when nothing moved.
+	 * Runs every frame after movement, queries that need exact positions earlier in the frame call it themselves */
+	void SyncTransforms();
+
+	/** Tick function of the per frame sync, for tick functions that have to run after it */
+	FTickFunction& GetSyncTickFunction() { return SyncTickFunction; }
+
+	/** How long the last non empty sync took, in milliseconds */
+	UFUNCTION(BlueprintPure, Category = "RTSCamera - Selection")
+	float GetLastSyncMilliseconds() const { return LastSyncMilliseconds; }
+
+	/** How many moved units the last non empty sync read back */
+	UFUNCTION(BlueprintPure, Category = "RTSCamera - Selection")
+	int32 GetLastSyncedCount() const { return LastSyncedCount; }
+
+	/** @return Small integer shared by every registered unit of the exact same class */
+	int32 GetClassId(const int32 Slot) const { return ClassIds[Slot]; }
+
+	/** @return The slots of every registered unit of the class, in no particular order */
+	const TArray<int32>& GetSlotsOfClass(const int32 ClassId) const { return SlotsByClassId[ClassId]; }
+
+	const TArray<AActor*>& GetActors() const { return Actors; }
+	const TArray<FVector>& GetLocations() const { return Locations; }
+	const TArray<float>& GetBoundsRadii() const { return BoundsRadii; }
+	TArray<uint8>& GetSignificance() { return Significance; }
+
+	/** Compiles the rules for every class registered so far, classes that show up later are compiled on their first registration */
+	void SetSelectionRules(TConstArrayView<FRTSSelectionRule> Rules);
+
+	bool HasSelectionRules() const { return SelectionRules.Num() > 0; }
+
+	const FRTSCompiledSelectionRule& GetSelectionRule(const int32 ClassId) const { return RulesByClassId[ClassId]; }
+
+	/** For actors that are not registered, compiles the rules for their class on the spot */
+	FRTSCompiledSelectionRule CompileSelectionRule(const UClass* Class) const { return FRTSCompiledSelectionRule::Compile(SelectionRules, Class); }
+
+	/** Routes selection events of the class and its subclasses to a native handler, the most derived registered class
+	 * wins. Pass nullptr to go back to the per actor interface events */
+	void SetBatchedSelectionHandler(const UClass* Class, TSharedPtr<IRTSBatchedSelectionHandler> Handler);
+
+	/** Fires OnDeselected then OnSelected on the units, in one call per native handler for the classes that have one
+	 * and per actor through IRTSSelection for everything else */
+	void DispatchSelectionEvents(TConstArrayView<AActor*> Selected, TConstArrayView<AActor*> Deselected);
+
+	/** Server: hands out the smallest free network id so ids of units spawned together stay close to each other
+	 * @return The network id or INDEX_NONE if we ran out of ids */
+	int32 AssignNetId(AActor* Actor);
+
+	/** Client: records the network id the server assigned to the actor */
+	void BindNetId(AActor* Actor, int32 NetId);
+
+	/** Frees (server) or forgets (client) the network id of the actor. Ids still claimed by a selector are held back
+	 * until every claim is dropped */
+	void ReleaseNetId(AActor* Actor);
+
+	/** Server: a selector's claimed bits went from Previous to Current. Released ids are only reused once nobody claims
+	 * them anymore, otherwise the next delta would validate a stale bit against the unit that got the id */
+	void UpdateNetIdClaims(const TBitArray<>& Previous, const TBitArray<>& Current);
+
+	/** @return The network id of the actor or INDEX_NONE */
+	int32 GetNetId(const AActor* Actor) const;
+
+	AActor* FindByNetId(const int32 NetId) const { return ActorsByNetId.IsValidIndex(NetId) ? ActorsByNetId[NetId] : nullptr; }
+
+	/** One past the highest network id in use, the size selection bitsets need */
+	int32 GetNetIdCapacity() const { return ActorsByNetId.Num(); }
+
+	/** Adds a source of selectable units that are not actors
+	 * @return The id stored in the FRTSEntityHandle of its entities */
+	UFUNCTION(BlueprintCallable, Category = "RTSCamera - Selection")
+	int32 RegisterEntitySource(URTSEntitySelectionSource* Source);
+
+	UFUNCTION(BlueprintCallable, Category = "RTSCamera - Selection")
+	void UnregisterEntitySource(URTSEntitySelectionSource* Source);
+
+	/** Indexed by source id, unregistered sources leave a null entry so ids stay stable */
+	const TArray<URTSEntitySelectionSource*>& GetEntitySources() const { return EntitySources; }
+
+	/** Fired after an actor got its slot */
+	FOnSelectableRegistryChanged OnSelectableRegistered;
+
+	/** Fired right before an actor leaves its slot, the slot is still valid while the delegate runs */
+	FOnSelectableRegistryChanged OnSelectableUnregistered;
+
+private:
+	void RemoveSlot(int32 Slot);
+	void HandleTransformUpdated(USceneComponent* Component, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport);
+
+	UPROPERTY()
+	TArray<AActor*> Actors;
+
+	/** World space bounds center per slot */
+	TArray<FVector> Locations;
+
+	/** Offset from the actor location to its bounds center, captured on registration */
+	TArray<FVector> BoundsOffsets;
+
+	TArray<float> BoundsRadii;
+
+	/** Significance bucket per slot, owned by URTSSignificanceSubsystem */
+	TArray<uint8> Significance;
+
+	/** Actor location per slot as of its last move, written by HandleTransformUpdated */
+	TArray<FVector> MovedLocations;
+
+	/** Set per slot when the unit moved since the last sync */
+	TBitArray<> Moved;
+	int32 NumMoved = 0;
+
+	/** Scratch list of the moved slots, handed to the parallel sync */
+	TArray<int32> SyncSlots;
+
+	FRTSSelectableRegistryTickFunction SyncTickFunction;
+	float LastSyncMilliseconds = 0;
+	int32 LastSyncedCount = 0;
+
+	TMap<const AActor*, int32> SlotByActor;
+
+	/** Class id per slot, plus where the slot sits in the slot list of its class so removal stays O(1) */
+	TArray<int32> ClassIds;
+	TArray<int32> ClassListIndices;
+	TArray<TArray<int32>> SlotsByClassId;
+	TMap<const UClass*, int32> ClassIdByClass;
+
+	TArray<FRTSSelectionRule> SelectionRules;
+
+	/** Indexed by class id */
+	TArray<FRTSCompiledSelectionRule> RulesByClassId;
+
+	TMap<const UClass*, TSharedPtr<IRTSBatchedSelectionHandler>> BatchedHandlersByClass;
+
+	/** Indexed by class id */
+	TArray<FRTSSelectionDispatch> DispatchByClassId;
+
+	/** Scratch buffers for DispatchSelectionEvents, per class id plus the class ids that got units */
+	TArray<TArray<AActor*>> BatchesByClassId;
+	TArray<int32> BatchedClassIds;
+
+	FRTSSelectionDispatch ResolveSelectionDispatch(const UClass* Class) const;
+	void DispatchSelectionEvent(TConstArrayView<AActor*> Actors, bool bSelected);
+
+	/** Indexed by network id, independent from the slots since ids have to stay stable while slots move */
+	UPROPERTY()
+	TArray<AActor*> ActorsByNetId;
+
+	TMap<const AActor*, int32> NetIdByActor;
+
+	/** Min-heap of released ids */
+	TArray<int32> FreeNetIds;
+
+	/** How many selectors claim each id, indexed by network id */
+	TArray<uint16> NetIdClaims;
+
+	/** Released ids waiting for their last claim to go away before they go back on the heap */
+	TBitArray<> QuarantinedNetIds;
+
+	UPROPERTY()
+	TArray<URTSEntitySelectionSource*> EntitySources;
+};
@@ -0,0 +1,57 @@
+// Copyright 2024 Jesus Bracho All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RTSSelectionFrustum.generated.h"
+
+struct FRTSScreenProjector;
+struct FRTSVisibilityGrid;
+
+/** When a unit counts as inside the selection box */
+UENUM(BlueprintType)
+enum class ERTSBoxSelectionTest : uint8
+{
+	/** The center of the unit's bounds is inside the box */
+	CenterInside,
+	/** Any part of the unit's bounds is inside the box, what the HUD's actor query does by default */
+	AnyOverlap,
+	/** The unit's bounds are entirely inside the box, like bActorMustBeFullyEnclosed */
+	FullyEnclosed,
+};
+
+/**
+ * The part of the view a screen rectangle covers, as its four side planes plus the near plane. Units are classified by
+ * testing their bounding sphere against the planes, a handful of dot products per unit instead of projecting the
+ * corners of their bounds to the screen. Works for perspective and orthographic views.
+ * Has no UObject dependencies so it can be exercised headless.
+ */
+struct OPENRTSCAMERA_API FRTSSelectionFrustum
+{
+	static constexpr int32 NumPlanes = 5;
+
+	/** Builds the planes for the rectangle, in viewport pixels like the mouse position
+	 * @return False if the rectangle has no area */
+	bool Build(const FRTSScreenProjector& Projector, const FVector2D& FirstPoint, const FVector2D& SecondPoint);
+
+	/** Appends the indices of the spheres that pass the test, in order
+	 * @param VisibilityGrid - Optional, spheres centered in a hidden cell are skipped before any plane is tested */
+	void Classify(TConstArrayView<FVector> Centers, TConstArrayView<float> Radii, ERTSBoxSelectionTest Test, TArray<int32>& OutIndices,
+	              const FRTSVisibilityGrid* VisibilityGrid = nullptr) const;
+
+	bool Passes(const FVector& Center, const float Radius, const ERTSBoxSelectionTest Test) const
+	{
+		// Normals point out of the box, so a sphere is inside a plane when its signed distance is at most -Radius
+		const double Margin = Test == ERTSBoxSelectionTest::AnyOverlap ? Radius : Test == ERTSBoxSelectionTest::FullyEnclosed ? -Radius : 0.0;
+		for (int32 Plane = 0; Plane < NumPlanes; ++Plane)
+		{
+			if (Planes[Plane].PlaneDot(Center) > Margin)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	FPlane Planes[NumPlanes];
+};
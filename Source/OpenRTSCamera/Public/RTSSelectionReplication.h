@@ -0,0 +1,32 @@
+// Copyright 2024 Jesus Bracho All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FBitReader;
+class FBitWriter;
+
+/**
+ * Encodes selections as bitsets indexed by the network ids of URTSSelectableRegistry.
+ * Bitsets are sent as alternating run lengths (zeros first) of packed ints, which stays a handful of bytes for box
+ * selections since ids are handed out smallest first and units spawned together end up next to each other.
+ * Has no UObject dependencies so it can be exercised headless.
+ */
+struct OPENRTSCAMERA_API FRTSSelectionBitsetCodec
+{
+	/** Writes the set bits of Bits as run lengths, trailing zeros are omitted */
+	static void WriteRuns(FBitWriter& Writer, const TBitArray<>& Bits);
+
+	/** Reads run lengths written by WriteRuns, fails on payloads that would grow past MaxBits */
+	static bool ReadRuns(FBitReader& Reader, int32 MaxBits, TBitArray<>& OutBits);
+
+	/** @return True if any bit differs, missing bits count as unset */
+	static bool HasDifferences(const TBitArray<>& Previous, const TBitArray<>& Current);
+
+	/** Writes Previous ^ Current, the bitsets may differ in size, missing bits count as unset */
+	static void WriteDelta(FBitWriter& Writer, const TBitArray<>& Previous, const TBitArray<>& Current);
+
+	/** Flips the bits described by a WriteDelta payload in place */
+	static bool ReadDelta(FBitReader& Reader, int32 MaxBits, TBitArray<>& InOutBits);
+};
@@ -0,0 +1,126 @@
+// Copyright 2024 Jesus Bracho All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "RTSSelectionRings.generated.h"
+
+class UInstancedStaticMeshComponent;
+class UMaterialInterface;
+class URTSSelectableRegistry;
+class URTSSelector;
+class UStaticMesh;
+
+/**
+ * CPU side of the selection ring instances: one dense transform per ring, swap-removed so the instance count only
+ * ever shrinks from the end, plus the range of instances that changed since the last upload.
+ * Has no UObject dependencies so it can be exercised headless.
+ */
+struct OPENRTSCAMERA_API FRTSSelectionRingBuffer
+{
+	/** @return The instance index of the ring, or of the existing ring if the key already has one */
+	int32 Add(const void* Key, const FTransform& Transform);
+
+	/** Moves the last ring into the freed instance
+	 * @return False if the key has no ring */
+	bool Remove(const void* Key);
+
+	/** Stores the new transform only if the ring drifted further than the tolerance
+	 * @return True if the ring was marked dirty */
+	bool Update(int32 Index, const FTransform& Transform, float Tolerance);
+
+	/** @return The instance index of the ring of the key or INDEX_NONE */
+	int32 Find(const void* Key) const;
+
+	int32 Num() const { return Keys.Num(); }
+	const void* GetKey(const int32 Index) const { return Keys[Index]; }
+	const TArray<FTransform>& GetTransforms() const { return Transforms; }
+
+	/** Inclusive range of instances whose transform changed since the last ClearDirty() */
+	bool IsDirty() const { return FirstDirty <= LastDirty; }
+	int32 GetFirstDirty() const { return FirstDirty; }
+	int32 GetLastDirty() const { return LastDirty; }
+	void ClearDirty();
+
+private:
+	void MarkDirty(int32 Index);
+
+	TArray<const void*> Keys;
+	TArray<FTransform> Transforms;
+	TMap<const void*, int32> IndexByKey;
+	int32 FirstDirty = MAX_int32;
+	int32 LastDirty = INDEX_NONE;
+};
+
+/**
+ * Draws the selection ring of every selected unit through one instanced static mesh component.
+ * Selectors push their selection here, each frame the rings of units that moved are uploaded in a single batch.
+ */
+UCLASS(Config=Game)
+class OPENRTSCAMERA_API URTSSelectionRingSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/** Replaces the units the selector wants rings for, units selected by several selectors share one ring */
+	void SetSelectedActors(const URTSSelector* Selector, const TArray<AActor*>& Actors);
+
+	UFUNCTION(BlueprintPure, Category = "RTSCamera - Selection")
+	int32 GetNumRings() const { return Buffer.Num(); }
+
+	/** Mesh drawn under each selected unit, scaled to the unit's bounds. Expected to be 100 units wide, like the engine plane */
+	UPROPERTY(Config)
+	TSoftObjectPtr<UStaticMesh> RingMesh = TSoftObjectPtr<UStaticMesh>(FSoftObjectPath(TEXT("/Engine/BasicShapes/Plane.Plane")));
+
+	/** Has to be a surface material, deferred decal materials do not render on meshes */
+	UPROPERTY(Config)
+	TSoftObjectPtr<UMaterialInterface> RingMaterial = TSoftObjectPtr<UMaterialInterface>(FSoftObjectPath(TEXT("/OpenRTSCamera/M_UnitSelection.M_UnitSelection")));
+
+	/** Ring diameter relative to the horizontal size of the unit's bounds */
+	UPROPERTY(Config)
+	float RingScale = 1.2f;
+
+	/** Lifts the ring above the bottom of the unit's bounds to avoid z-fighting with the ground, in cm */
+	UPROPERTY(Config)
+	float RingHeightOffset = 2.0f;
+
+	/** Rings that moved less than this since their last upload are left alone, in cm */
+	UPROPERTY(Config)
+	float MoveTolerance = 1.0f;
+
+private:
+	struct FRing
+	{
+		TWeakObjectPtr<AActor> Actor;
+		int32 RefCount = 0;
+		FVector Offset = FVector::ZeroVector;
+		float Scale = 1;
+	};
+
+	void AddRing(AActor* Actor);
+	void RemoveRing(const AActor* Actor);
+
+	/** Drops the ring no matter how many selectors hold it and forgets the unit in every selection, so no stale pointer survives it */
+	void DiscardRing(const AActor* Actor);
+	void HandleSelectableUnregistered(AActor* Actor, int32 Slot);
+	FTransform GetRingTransform(const AActor* Actor, const FRing& Ring) const;
+	bool EnsureRingComponent();
+	void UploadInstances();
+
+	UPROPERTY()
+	URTSSelectableRegistry* Registry;
+
+	UPROPERTY()
+	UInstancedStaticMeshComponent* RingComponent;
+
+	TMap<const URTSSelector*, TArray<const AActor*>> SelectionBySelector;
+	TMap<const AActor*, FRing> Rings;
+	FRTSSelectionRingBuffer Buffer;
+	FDelegateHandle UnregisteredHandle;
+};
@@ -0,0 +1,51 @@
+// Copyright 2024 Jesus Bracho All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RTSSelectionRules.generated.h"
+
+/** One entry of URTSSelector::SelectionRules, the first rule matching a unit's class decides how it is selected */
+USTRUCT(BlueprintType)
+struct FRTSSelectionRule
+{
+	GENERATED_BODY()
+
+	/** Matches this class and its children, leave empty to match any class */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera - Selection")
+	TSubclassOf<AActor> ActorClass;
+
+	/** Only matches classes whose default object carries this tag, leave empty to ignore tags */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera - Selection")
+	FName ClassTag;
+
+	/** Higher priorities are preferred, see URTSSelector::bKeepOnlyHighestPriority and MaxSelectedUnits */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera - Selection")
+	int32 Priority = 0;
+
+	/** Only selected if nothing without this flag is in the selection, typically buildings */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera - Selection")
+	bool bSelectOnlyWhenAlone = false;
+
+	/** Never selected at all */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera - Selection")
+	bool bNeverSelect = false;
+};
+
+enum class ERTSSelectionRuleFlags : uint8
+{
+	None = 0,
+	OnlyWhenAlone = 1 << 0,
+	NeverSelect = 1 << 1,
+};
+ENUM_CLASS_FLAGS(ERTSSelectionRuleFlags);
+
+/** What the rules boil down to for one class, looked up by class id in the selectable registry */
+struct OPENRTSCAMERA_API FRTSCompiledSelectionRule
+{
+	ERTSSelectionRuleFlags Flags = ERTSSelectionRuleFlags::None;
+	int32 Priority = 0;
+
+	/** Resolves the first rule that matches the class */
+	static FRTSCompiledSelectionRule Compile(TConstArrayView<FRTSSelectionRule> Rules, const UClass* Class);
+};
@@ -6,10 +6,18 @@
 #include "InputAction.h"
 #include "InputMappingContext.h"
 #include "Components/ActorComponent.h"
+#include "RTSCameraSubsystem.h"
+#include "RTSEntitySelection.h"
+#include "RTSScreenClustering.h"
+#include "RTSSelectionFrustum.h"
+#include "RTSVisibilityGrid.h"
 #include "RTSSelector.generated.h"
 
+struct FStreamableHandle;
 class IRTSSelection;
 class ARTSHUD;
+class URTSSelectableRegistry;
+class URTSSelectionRingSubsystem;
 
 UCLASS(Blueprintable, BlueprintType, ClassGroup=(Custom), meta=(BlueprintSpawnableComponent))
 class OPENRTSCAMERA_API URTSSelector : public UActorComponent
@@ -19,16 +27,24 @@ class OPENRTSCAMERA_API URTSSelector : public UActorComponent
 public:
 	URTSSelector();
 
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
 	DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnActorsSelected, const TArray<AActor*>&, SelectedActors);
 	UPROPERTY(BlueprintAssignable, BlueprintCallable, Category = "RTSCamera")
 	FOnActorsSelected OnActorsSelected;
 
-	/** BlueprintReadWrite allows access and modification in Blueprints */
+	DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnSelectionChanged, const TArray<AActor*>&, AddedActors, const TArray<AActor*>&, RemovedActors);
+	/** Fired once per change of SelectedActors with only the units that entered and left it, units that leave play
+	 * while selected are pruned automatically and reported here as well */
+	UPROPERTY(BlueprintAssignable, Category = "RTSCamera - Selection")
+	FOnSelectionChanged OnSelectionChanged;
+
+	/** Soft so loading the class does not load them, streamed in on BeginPlay and bound once they arrive */
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera - Inputs")
-	UInputMappingContext* InputMappingContext;
+	TSoftObjectPtr<UInputMappingContext> InputMappingContext;
 
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera - Inputs")
-	UInputAction* BeginSelection;
+	TSoftObjectPtr<UInputAction> BeginSelection;
 
 	/** Function to clear selected actors, can be overridden in Blueprints  */
 	UFUNCTION(BlueprintCallable, BlueprintNativeEvent, Category = "RTSCamera - Selection")
@@ -48,13 +64,174 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "RTSCamera - Selection")
 	void OnSelectionEnd(const FInputActionValue& Value);
 
+	/** Dense and in no particular order, use IsActorSelected to test for membership */
 	UPROPERTY(BlueprintReadOnly, Category = "RTSCamera - Selection")
 	TArray<AActor*> SelectedActors;
 
+	/** Constant time, unlike searching SelectedActors */
+	UFUNCTION(BlueprintPure, Category = "RTSCamera - Selection")
+	bool IsActorSelected(const AActor* Actor) const { return SelectedIndexByActor.Contains(Actor); }
+
+	/** Resolved per class (first match wins) when play begins and stored in the selectable registry, then applied to
+	 * every selection in one pass. The registry holds one rule set per world, the last selector to begin play wins */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera - Selection Rules")
+	TArray<FRTSSelectionRule> SelectionRules;
+
+	/** Drop everything below the highest rule priority in the selection, e.g. combat units win over workers */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera - Selection Rules")
+	bool bKeepOnlyHighestPriority;
+
+	/** Keep at most this many units, those with the highest rule priority first, 0 for no limit */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera - Selection Rules", meta = (ClampMin = "0"))
+	int32 MaxSelectedUnits;
+
+	/** Should a press and release without dragging select the unit under the cursor?
+	 * Only used while box selection also goes through the registry, otherwise a click goes to ARTSHUD::PerformSelection as a small box */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera - Selection")
+	bool bEnableClickSelection;
+
+	/** Releases closer than this to the press, in pixels, are clicks rather than box selections */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera - Selection", meta = (EditCondition = "bEnableClickSelection"))
+	float ClickDragThreshold;
+
+	/** Extra pixels around a unit's projected bounds that still count as clicking it */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera - Selection", meta = (EditCondition = "bEnableClickSelection"))
+	float ClickTolerance;
+
+	/** Clicking the same unit twice within this many seconds selects every unit of its class on screen */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera - Selection", meta = (EditCondition = "bEnableClickSelection"))
+	float DoubleClickTime;
+
+	/** Picks the registered unit under the screen position against its cached bounds, no physics trace involved
+	 * @return The closest unit to the camera under the position, or nullptr */
+	UFUNCTION(BlueprintCallable, Category = "RTSCamera - Selection")
+	AActor* PickSelectableAt(const FVector2D& ScreenPosition) const;
+
+	/** Selects the unit under the screen position, or every unit of its class currently on screen */
+	UFUNCTION(BlueprintCallable, Category = "RTSCamera - Selection")
+	void SelectAtScreenPosition(const FVector2D& ScreenPosition, bool bSelectAllOfClassOnScreen);
+
+	/** Group units that overlap on screen into clusters when zoomed far out, box and click selection then work on whole clusters. Off by default */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera - Clustering")
+	bool bEnableClustering;
+
+	/** Arm length of the player's RTS camera beyond which clustering kicks in */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera - Clustering", meta = (EditCondition = "bEnableClustering"))
+	float ClusterZoomLength;
+
+	/** Size in pixels of the screen cells units are grouped by */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera - Clustering", meta = (EditCondition = "bEnableClustering", ClampMin = "1.0"))
+	float ClusterCellSize;
+
+	/** Hands the selector the fog of war of its player's team, units in hidden cells can no longer be box, click or
+	 * cluster selected. The grid is shared with the fog system which keeps updating it, pass nullptr to select everything again */
+	void SetVisibilityGrid(TSharedPtr<const FRTSVisibilityGrid> InVisibilityGrid);
+
+	bool HasVisibilityGrid() const { return VisibilityGrid.IsValid(); }
+
+	/** False if a visibility grid is set and the location is in a hidden cell */
+	bool IsLocationVisible(const FVector& Location) const { return !VisibilityGrid.IsValid() || VisibilityGrid->IsVisible(Location); }
+
+	/** Box select registered units against the planes of the box instead of the HUD's per actor bounds query. Turn off
+	 * if some of your selectable actors have no URTSSelectable component, they are only found by the HUD's query */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera - Selection")
+	bool bBoxSelectFromRegistry;
+
+	/** What it takes for a registered unit to be inside the selection box */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera - Selection")
+	ERTSBoxSelectionTest BoxSelectionTest;
+
+	/** True if box selection goes through SelectSelectablesInRectangle, always the case once a visibility grid is set */
+	bool CanBoxSelectFromRegistry() const;
+
+	/** Selects every registered unit inside the rectangle according to BoxSelectionTest. The rectangle is turned into
+	 * planes once and tested against the registry's cached bounds, nothing is projected to the screen */
+	UFUNCTION(BlueprintCallable, Category = "RTSCamera - Selection")
+	void SelectSelectablesInRectangle(const FVector2D& FirstPoint, const FVector2D& SecondPoint);
+
+	/** Screen space bounds of every registered unit SelectSelectablesInRectangle would select right now.
+	 * Used by the HUD to highlight units while the box is dragged */
+	void GetSelectableScreenBoundsInRectangle(const FVector2D& FirstPoint, const FVector2D& SecondPoint, TArray<FBox2D>& OutScreenBounds) const;
+
+	/** Draw a ring under every selected unit through the shared instanced selection ring subsystem,
+	 * leave it off if your units show their own marker from OnSelected */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera - Selection")
+	bool bShowSelectionRings;
+
+	/** Is the camera zoomed out far enough for selection to work on clusters? */
+	UFUNCTION(BlueprintPure, Category = "RTSCamera - Clustering")
+	bool IsClusteringActive() const;
+
+	/** Selects every unit of every cluster whose center is inside the rectangle */
+	UFUNCTION(BlueprintCallable, Category = "RTSCamera - Clustering")
+	void SelectClustersInRectangle(const FVector2D& FirstPoint, const FVector2D& SecondPoint);
+
+	/** The selected units grouped by screen cell, draw one selection marker per cluster instead of one per unit */
+	UFUNCTION(BlueprintCallable, Category = "RTSCamera - Clustering")
+	TArray<FRTSScreenCluster> GetSelectedClusters();
+
+	DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnEntitiesSelected, const TArray<FRTSEntityHandle>&, SelectedEntities);
+
+	/** Counterpart of OnActorsSelected for units of the registry's entity sources (mass entities, mesh instances...) */
+	UPROPERTY(BlueprintAssignable, Category = "RTSCamera - Selection")
+	FOnEntitiesSelected OnEntitiesSelected;
+
+	/** Selected units that are not actors, sorted by source and index */
+	UPROPERTY(BlueprintReadOnly, Category = "RTSCamera - Selection")
+	TArray<FRTSEntityHandle> SelectedEntities;
+
+	/** Replaces the entity selection with every entity of the registry's sources whose center projects inside the rectangle */
+	UFUNCTION(BlueprintCallable, Category = "RTSCamera - Selection")
+	void SelectEntitiesInRectangle(const FVector2D& FirstPoint, const FVector2D& SecondPoint);
+
+	/** Replaces the entity selection, notifies the sources of what changed and fires OnEntitiesSelected */
+	UFUNCTION(BlueprintCallable, Category = "RTSCamera - Selection")
+	void HandleSelectedEntities(const TArray<FRTSEntityHandle>& NewSelectedEntities);
+
+	/** Where the cursor meets the ground this frame, computed once for every consumer of this player */
+	UFUNCTION(BlueprintPure, Category = "RTSCamera - Selection")
+	FRTSCursorGroundHit GetCursorGroundHit() const;
+
+	/** Send every selection change to the server, which validates it and keeps the authoritative selection.
+	 * Only units with a URTSSelectable component (which hands out the network ids) can be replicated. */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera - Replication")
+	bool bReplicateSelection;
+
+	/** Let the server accept units that are not owned by this player controller or its pawn */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera - Replication", meta = (EditCondition = "bReplicateSelection"))
+	bool bAllowSelectingUnownedActors;
+
+	DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnAuthoritativeSelectionChanged, const TArray<AActor*>&, AuthoritativeSelectedActors);
+
+	/** Server only: fired after a selection change of this player was validated */
+	UPROPERTY(BlueprintAssignable, Category = "RTSCamera - Replication")
+	FOnAuthoritativeSelectionChanged OnAuthoritativeSelectionChanged;
+
+	/** Server only: the validated selection of this player, this is what orders should be issued to */
+	UPROPERTY(BlueprintReadOnly, Category = "RTSCamera - Replication")
+	TArray<AActor*> AuthoritativeSelectedActors;
+
+	/** Average payload of the selection changes sent (client) or received (server) so far, in bytes */
+	UFUNCTION(BlueprintPure, Category = "RTSCamera - Replication")
+	float GetAverageBytesPerSelectionChange() const;
+
+	UFUNCTION(BlueprintPure, Category = "RTSCamera - Replication")
+	int32 GetLastSelectionChangeBytes() const { return LastSelectionChangeBytes; }
+
 protected:
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	virtual void SetupPlayerInputComponent(UInputComponent* PlayerInputComponent);
 
+	/** Server side ownership check, runs once per unit in the validation pass */
+	virtual bool CanServerSelect(const AActor* Actor) const;
+
+	UFUNCTION(Server, Reliable)
+	void ServerReceiveSelectionDelta(const TArray<uint8>& Payload);
+
+	UFUNCTION(Client, Reliable)
+	void ClientRejectSelection(const TArray<uint8>& Payload);
+
 private:
 	UPROPERTY()
 	APlayerController* PlayerController;
@@ -67,7 +244,88 @@ private:
 
 	bool bIsSelecting;
 
+	UPROPERTY()
+	URTSSelectableRegistry* Registry;
+
+	UPROPERTY()
+	URTSCameraSubsystem* CameraSubsystem;
+
+	UPROPERTY()
+	URTSSelectionRingSubsystem* SelectionRings;
+
+	/** Client: the selection as last sent to the server. Server: the selection as last received, before validation */
+	TBitArray<> ReplicatedSelectionBits;
+
+	/** Where each selected actor sits in SelectedActors */
+	TMap<const AActor*, int32> SelectedIndexByActor;
+
+	/** Units were pruned from the selection, everything that mirrors it is updated once on the next tick */
+	bool bSelectionPruned = false;
+
+	FDelegateHandle SelectableUnregisteredHandle;
+
+	/** Set while the input assets are streaming in */
+	TSharedPtr<FStreamableHandle> InputAssetsHandle;
+	double InputAssetsRequestTime = 0;
+
+	/** Keeps the streamed input assets loaded while they are bound, the soft pointers alone do not */
+	UPROPERTY()
+	TArray<UObject*> LoadedInputAssets;
+
+	UPROPERTY()
+	AActor* LastClickedActor;
+
+	double LastClickTime = 0;
+
+	int32 LastSelectionChangeBytes = 0;
+	int64 TotalSelectionChangeBytes = 0;
+	int32 NumSelectionChanges = 0;
+
+	TSharedPtr<const FRTSVisibilityGrid> VisibilityGrid;
+
+	/** Clusters of every registered unit, built at most once per frame */
+	FRTSScreenClusterGrid UnitClusters;
+
+	FRTSScreenClusterGrid SelectedClusters;
+
+	/** Scratch buffer reused by every entity query */
+	FRTSEntityCandidates EntityCandidates;
+
+	const FRTSScreenClusterGrid* UpdateUnitClusters();
+	/** Registry slots of the visible units inside the rectangle, with the projector the test was built from */
+	bool GatherSelectableSlotsInRectangle(const FVector2D& FirstPoint, const FVector2D& SecondPoint, FRTSScreenProjector& OutProjector, TArray<int32>& OutSlots) const;
+	void GatherOnScreenSelectablesOfClass(int32 ClassId, TArray<AActor*>& OutActors) const;
+	/** Filters and caps a selection according to SelectionRules, bKeepOnlyHighestPriority and MaxSelectedUnits */
+	void ApplySelectionRules(TArray<AActor*>& Actors) const;
+
+	void AddSelectedActor(AActor* Actor);
+	/** Swaps the last selected actor into the freed index */
+	void RemoveSelectedActorAt(int32 Index);
+	void PruneSelectedActor(AActor* Actor);
+	void HandleSelectableUnregistered(AActor* Actor, int32 Slot);
+
+	/** Only bound for selected actors that are not in the registry, the registry already tells us about the others */
+	UFUNCTION()
+	void OnSelectedActorEndPlay(AActor* Actor, EEndPlayReason::Type EndPlayReason);
+
+	/** SelectAtScreenPosition with the unit under the position already picked, so a click only picks once */
+	void SelectPickedAtScreenPosition(const FVector2D& ScreenPosition, AActor* Picked, bool bSelectAllOfClassOnScreen);
+
+	/** OnDeselected then OnSelected, batched per class for classes with a native handler in the registry */
+	void DispatchSelectionEvents(TConstArrayView<AActor*> Added, TConstArrayView<AActor*> Removed) const;
+
+	/** Pushes a change of SelectedActors to everything that mirrors it (server, selection rings) */
+	void NotifySelectionChanged();
+	void ConditionallyReplicateSelection();
+	void ValidateReplicatedSelection();
+	void DeselectRejected(const TBitArray<>& Rejected);
+	void CountSelectionChange(int32 NumBytes);
+
 	void BindInputActions();
 	void BindInputMappingContext() const;
 	void CollectComponentDependencyReferences();
+
+	/** Binds right away when the input assets are in memory, otherwise once they are streamed in */
+	void RequestInputAssets();
+	void OnInputAssetsLoaded();
 };
@@ -0,0 +1,119 @@
+// Copyright 2024 Jesus Bracho All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "RTSSignificanceSubsystem.generated.h"
+
+class URTSSelectableRegistry;
+
+/** What a registered unit is allowed to cost while it sits in a given significance bucket */
+USTRUCT(BlueprintType)
+struct FRTSSignificanceBucketSettings
+{
+	GENERATED_BODY()
+
+	/** Units up to this distance outside the camera footprint land in this bucket, the last bucket catches everything beyond */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera|Significance")
+	float MaxDistance = 0;
+
+	/** Tick interval of the unit actor itself, 0 ticks every frame */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera|Significance")
+	float ActorTickInterval = 0;
+
+	/** Tick interval of skinned mesh components, this is what throttles the animation update rate */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera|Significance")
+	float AnimationTickInterval = 0;
+
+	/** Tick interval of particle and niagara components */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera|Significance")
+	float EffectsTickInterval = 0;
+
+	/** Should widget components (health bars, names...) stay visible? */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "RTSCamera|Significance")
+	bool bShowWidgets = true;
+
+	bool operator==(const FRTSSignificanceBucketSettings& Other) const
+	{
+		return MaxDistance == Other.MaxDistance && ActorTickInterval == Other.ActorTickInterval && AnimationTickInterval == Other.AnimationTickInterval
+			&& EffectsTickInterval == Other.EffectsTickInterval && bShowWidgets == Other.bShowWidgets;
+	}
+};
+
+/** The ground footprint of a camera for the current frame */
+USTRUCT()
+struct FRTSSignificanceViewpoint
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FVector FootprintCenter = FVector::ZeroVector;
+
+	UPROPERTY()
+	float FootprintRadius = 0;
+
+	UPROPERTY()
+	float ZoomLength = 0;
+};
+
+/**
+ * Buckets the units of the URTSSelectableRegistry by their distance to the camera footprints and the zoom level,
+ * then throttles their ticking, animation and widgets. Only a budgeted slice of the registry is re-bucketed per frame
+ * and only the units that changed bucket are touched, in one batch.
+ */
+UCLASS()
+class OPENRTSCAMERA_API URTSSignificanceSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/** Called by every active camera each frame, viewpoints are consumed by the next update */
+	void ReportViewpoint(const FRTSSignificanceViewpoint& Viewpoint);
+
+	/** Buckets are shared by every camera of the world, so only the first call sets them. Later calls with other settings
+	 * (another rig, a split screen player) are ignored with a warning instead of re-bucketing every unit
+	 * @return False if the settings were ignored */
+	bool Configure(const TArray<FRTSSignificanceBucketSettings>& InBuckets, float InZoomedOutLength, int32 InUpdateBudget);
+
+	/** Re-buckets up to Budget units, continuing where the previous update stopped
+	 * @return How many units changed bucket */
+	UFUNCTION(BlueprintCallable, Category = "RTSCamera|Significance")
+	int32 UpdateSignificance(int32 Budget);
+
+	UFUNCTION(BlueprintPure, Category = "RTSCamera|Significance")
+	int32 GetNumUnitsInBucket(int32 Bucket) const;
+
+	UFUNCTION(BlueprintPure, Category = "RTSCamera|Significance")
+	TArray<int32> GetBucketCounts() const { return BucketCounts; }
+
+private:
+	int32 ComputeBucket(const FVector& Location) const;
+	void ApplyBucket(AActor* Actor, int32 Bucket) const;
+	void HandleSelectableUnregistered(AActor* Actor, int32 Slot);
+
+	UPROPERTY()
+	URTSSelectableRegistry* Registry;
+
+	UPROPERTY()
+	TArray<FRTSSignificanceBucketSettings> Buckets;
+
+	UPROPERTY()
+	TArray<FRTSSignificanceViewpoint> Viewpoints;
+
+	TArray<int32> BucketCounts;
+
+	/** Scratch buffer of (slot, new bucket) pairs, applied in one go at the end of an update */
+	TArray<TPair<int32, uint8>> PendingChanges;
+
+	FDelegateHandle UnregisteredHandle;
+	float ZoomedOutLength = 0;
+	int32 UpdateBudget = 256;
+	int32 Cursor = 0;
+	bool bConfigured = false;
+};
@@ -0,0 +1,55 @@
+// Copyright 2024 Jesus Bracho All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * One bit per ground cell telling whether a team can see it, filled by the game's fog of war.
+ * Selection queries test a unit's cell before doing any projection work, so hidden units cost a single bit test.
+ * Has no UObject dependencies so it can be exercised headless.
+ */
+struct OPENRTSCAMERA_API FRTSVisibilityGrid
+{
+	/** Resizes the grid and hides every cell
+	 * @param InOrigin - World XY of the corner of cell (0, 0)
+	 * @param InCellSize - Size of a cell, in cm */
+	void Initialize(const FVector2D& InOrigin, float InCellSize, int32 InWidth, int32 InHeight);
+
+	void SetCellVisible(int32 X, int32 Y, bool bVisible);
+
+	/** Sets or clears every cell at once */
+	void SetAllVisible(bool bVisible);
+
+	/** Replaces the bits wholesale, row major with X varying fastest, 64 cells per word like the fog texture of most games
+	 * @return False if the word count does not match the grid size */
+	bool SetWords(TConstArrayView<uint64> InWords);
+
+	/** Locations outside of the grid are treated as hidden.
+	 * Divides in double instead of multiplying by a rounded inverse, so a location on a cell edge always lands in the cell
+	 * that starts there, whatever the cell size and however far from the origin */
+	bool IsVisible(const FVector& Location) const
+	{
+		const int32 X = FMath::FloorToInt32((Location.X - Origin.X) / CellSize);
+		const int32 Y = FMath::FloorToInt32((Location.Y - Origin.Y) / CellSize);
+		if (static_cast<uint32>(X) >= static_cast<uint32>(Width) || static_cast<uint32>(Y) >= static_cast<uint32>(Height))
+		{
+			return false;
+		}
+
+		const int64 Bit = static_cast<int64>(Y) * Width + X;
+		return (Words[static_cast<int32>(Bit >> 6)] >> (Bit & 63)) & 1;
+	}
+
+	int32 GetWidth() const { return Width; }
+	int32 GetHeight() const { return Height; }
+	float GetCellSize() const { return static_cast<float>(CellSize); }
+	const FVector2D& GetOrigin() const { return Origin; }
+
+private:
+	FVector2D Origin = FVector2D::ZeroVector;
+	double CellSize = 100;
+	int32 Width = 0;
+	int32 Height = 0;
+	TArray<uint64> Words;
+};